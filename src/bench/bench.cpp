@@ -0,0 +1,409 @@
+/**
+ * @file bench.cpp
+ * @brief solver_bench: timings of the hot paths over a fixed puzzle corpus.
+ *
+ * Every benchmark is repeated until it has run for at least --min-time
+ * milliseconds and reports nanoseconds per call and calls per second as CSV
+ * on stdout. With --save the results are also written to a file, and with
+ * --baseline they are compared against such a file; benchmarks that got
+ * slower than --threshold percent are flagged and make the exit code 1.
+ * How often A* reaches the allocator, with a fresh and with a reused search
+ * context, and how long a context takes to tear down are reported on stderr.
+ */
+
+#include <batch.hpp>
+#include <board.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <distance_table.hpp>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <solver.hpp>
+#include <state_index.hpp>
+#include <string>
+#include <string_view>
+#include <types.hpp>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct BenchPuzzle {
+  std::string_view name;
+  /// pawn position followed by position and orientation of tiles A to H
+  std::string_view line;
+  int cost;
+};
+
+// the two DEBUG_INPUT cases of main.cpp come first
+constexpr BenchPuzzle CORPUS[] = {
+    {"easy/debug1", "9 41 73 13 23 83 32 64 92", 11},
+    {"easy/debug2", "2 12 43 82 24 63 33 73 92", 9},
+    {"easy/e10", "5 92 64 33 54 43 24 12 82", 10},
+    {"medium/m16", "7 21 82 91 41 51 62 73 11", 16},
+    {"medium/m21", "9 72 83 44 92 63 23 11 53", 21},
+    {"medium/m24", "1 33 52 44 81 74 23 11 91", 24},
+    {"hard/h35", "5 33 74 94 42 63 12 54 82", 35},
+    {"hard/h38", "7 82 91 22 64 43 14 52 73", 38},
+    {"hard/h39", "8 93 31 22 51 43 73 14 82", 39},
+    {"hard/h42", "4 62 53 81 92 13 32 43 72", 42},
+    {"hard/h47", "2 72 94 41 21 14 53 32 84", 47},
+    {"hard/h58", "2 42 74 14 34 81 92 21 64", 58},
+};
+
+/// states sampled per corpus board for the per-call benchmarks
+constexpr std::size_t SAMPLES_PER_BOARD = 2048;
+
+struct Options {
+  double min_time_ms = 200.0;
+  double threshold_pct = 10.0;
+  std::string save_path;
+  std::string baseline_path;
+};
+
+struct Result {
+  std::string name;
+  double ns_per_call;
+};
+
+/// @brief memory resource counting the calls that pass through to upstream
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+  std::size_t bytes = 0;
+
+ private:
+  std::pmr::memory_resource* upstream = std::pmr::new_delete_resource();
+
+  void* do_allocate(std::size_t size, std::size_t alignment) override {
+    allocations++;
+    bytes += size;
+    return upstream->allocate(size, alignment);
+  }
+  void do_deallocate(void* p, std::size_t size,
+                     std::size_t alignment) override {
+    deallocations++;
+    upstream->deallocate(p, size, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+/// @brief breadth first sample of the states around start
+std::vector<State> sample_states(const Board& board, const State& start) {
+  std::vector<State> states{start};
+  std::unordered_set<State> seen{start};
+  for (std::size_t i = 0;
+       i < states.size() && states.size() < SAMPLES_PER_BOARD; i++) {
+    for (const State& next : states[i].successors(board)) {
+      if (states.size() < SAMPLES_PER_BOARD && seen.insert(next).second) {
+        states.push_back(next);
+      }
+    }
+  }
+  return states;
+}
+
+/**
+ * @brief nanoseconds per call of body, which makes calls calls per run
+ * @paragraph
+ * The number of runs doubles until the total time reaches min_time_ms.
+ */
+double measure(const Options& options, std::size_t calls,
+               const std::function<void()>& body) {
+  using clock = std::chrono::steady_clock;
+  body();  // warm up caches and lazily built tables
+  for (std::size_t runs = 1;; runs *= 2) {
+    const auto start = clock::now();
+    for (std::size_t r = 0; r < runs; r++) body();
+    const std::chrono::duration<double, std::nano> elapsed =
+        clock::now() - start;
+    if (elapsed.count() >= options.min_time_ms * 1e6) {
+      return elapsed.count() / static_cast<double>(runs * calls);
+    }
+  }
+}
+
+std::map<std::string, double> load_results(const std::string& path) {
+  std::map<std::string, double> results;
+  std::ifstream in(path);
+  std::string line;
+  std::getline(in, line);  // header
+  while (std::getline(in, line)) {
+    const auto comma = line.find(',');
+    if (comma == std::string::npos) continue;
+    results[line.substr(0, comma)] = std::stod(line.substr(comma + 1));
+  }
+  return results;
+}
+
+std::optional<Options> parse_args(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    if (arg == "--min-time" && i + 1 < argc) {
+      options.min_time_ms = std::stod(argv[++i]);
+    } else if (arg == "--threshold" && i + 1 < argc) {
+      options.threshold_pct = std::stod(argv[++i]);
+    } else if (arg == "--save" && i + 1 < argc) {
+      options.save_path = argv[++i];
+    } else if (arg == "--baseline" && i + 1 < argc) {
+      options.baseline_path = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0] << " [options]\n"
+                << "  --min-time <ms>    time per benchmark (default 200)\n"
+                << "  --save <file>      write the results as CSV\n"
+                << "  --baseline <file>  compare with saved results\n"
+                << "  --threshold <pct>  slowdown flagged as regression "
+                   "(default 10)\n";
+      return std::nullopt;
+    }
+  }
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const auto options = parse_args(argc, argv);
+  if (!options) return 2;
+
+  std::vector<State> starts;
+  std::vector<Board> boards;
+  std::vector<std::vector<State>> samples;
+  std::size_t sample_count = 0;
+  for (const BenchPuzzle& entry : CORPUS) {
+    const auto puzzle = parse_puzzle(entry.line);
+    if (!puzzle) {
+      std::cerr << "invalid corpus puzzle " << entry.name << '\n';
+      return 2;
+    }
+    input_tile_data_t tiles = puzzle->tiles;
+    starts.push_back(State::from_input(puzzle->pawn_pos, tiles));
+    boards.emplace_back(tiles);
+    samples.push_back(sample_states(boards.back(), starts.back()));
+    sample_count += samples.back().size();
+  }
+
+  std::vector<Result> results;
+  // keeps the optimizer from dropping the measured calls
+  volatile std::uint64_t sink = 0;
+
+  results.push_back({"successors", measure(*options, sample_count, [&] {
+                       std::uint64_t acc = 0;
+                       for (std::size_t b = 0; b < boards.size(); b++) {
+                         for (const State& s : samples[b]) {
+                           acc += s.successors(boards[b]).size();
+                         }
+                       }
+                       sink = sink + acc;
+                     })});
+  results.push_back({"hash", measure(*options, sample_count, [&] {
+                       std::uint64_t acc = 0;
+                       const std::hash<State> hash;
+                       for (const auto& states : samples) {
+                         for (const State& s : states) acc ^= hash(s);
+                       }
+                       sink = sink + acc;
+                     })});
+  results.push_back({"heuristic", measure(*options, sample_count, [&] {
+                       std::uint64_t acc = 0;
+                       for (std::size_t b = 0; b < boards.size(); b++) {
+                         for (const State& s : samples[b]) {
+                           acc += static_cast<std::uint64_t>(
+                               s.heuristic(boards[b]));
+                         }
+                       }
+                       sink = sink + acc;
+                     })});
+  const StateRanker ranker;
+  results.push_back({"rank", measure(*options, sample_count, [&] {
+                       std::uint64_t acc = 0;
+                       for (const auto& states : samples) {
+                         for (const State& s : states) acc += ranker.index(s);
+                       }
+                       sink = sink + acc;
+                     })});
+  std::vector<std::uint32_t> ranks(SAMPLES_PER_BOARD);
+  results.push_back({"rank/batch", measure(*options, sample_count, [&] {
+                       std::uint64_t acc = 0;
+                       for (const auto& states : samples) {
+                         ranker.index_batch(states.data(), states.size(),
+                                            ranks.data());
+                         acc += ranks[states.size() - 1];
+                       }
+                       sink = sink + acc;
+                     })});
+  results.push_back(
+      {"distance_table/build", measure(*options, 1, [&] {
+         sink = sink + DistanceTable(boards.front(), 1).max_distance();
+       })});
+  // every (src, dst, dir) combination of tiles, table lookup vs scan
+  constexpr std::size_t MOVE_CALLS =
+      static_cast<std::size_t>(TileNames::End) *
+      static_cast<std::size_t>(TileNames::End) * 4;
+  auto move_bench = [&](bool scan) {
+    return [&, scan] {
+      std::uint64_t acc = 0;
+      for (const Board& board : boards) {
+        for (std::size_t src = 0;
+             src < static_cast<std::size_t>(TileNames::End); src++) {
+          for (std::size_t dst = 0;
+               dst < static_cast<std::size_t>(TileNames::End); dst++) {
+            for (std::int8_t dir = 0; dir < 4; dir++) {
+              const auto a = static_cast<TileNames>(src);
+              const auto b = static_cast<TileNames>(dst);
+              const auto d = static_cast<Directions>(dir);
+              acc += scan ? board.can_move_pawn_scan(a, b, d)
+                          : board.can_move_pawn(a, b, d);
+            }
+          }
+        }
+      }
+      sink = sink + acc;
+    };
+  };
+  results.push_back({"can_move_pawn/table",
+                     measure(*options, MOVE_CALLS * boards.size(),
+                             move_bench(false))});
+  results.push_back({"can_move_pawn/scan",
+                     measure(*options, MOVE_CALLS * boards.size(),
+                             move_bench(true))});
+
+  bool wrong_cost = false;
+  for (std::size_t i = 0; i < starts.size(); i++) {
+    const Board& board = boards[i];
+    auto successors = [&board](const State& s) { return s.successors(board); };
+    auto goal_test = [](const State& s) -> bool { return s.is_goal(); };
+    auto heuristics = [&board](const State& s) -> int {
+      return s.heuristic(board);
+    };
+    auto cost_between = [](const State&, const State&) -> int { return 1; };
+    auto solve = [&] {
+      return astar<BucketOpenList>(starts[i], successors, goal_test,
+                                   heuristics, cost_between);
+    };
+    const auto path = solve();
+    if (!path || static_cast<int>(path->size()) - 1 != CORPUS[i].cost) {
+      std::cerr << "wrong cost for " << CORPUS[i].name << '\n';
+      wrong_cost = true;
+    }
+    results.push_back(
+        {"astar/" + std::string(CORPUS[i].name),
+         measure(*options, 1, [&] { sink = sink + solve()->size(); })});
+  }
+
+  // the whole corpus through SearchContext: a new context per puzzle, whose
+  // arena starts empty and is freed afterwards, against one reused context
+  using Context = SearchContext<State, BucketOpenList>;
+  CountingResource counter;
+  auto solve_in = [&](Context& context, std::size_t i) {
+    const Board& board = boards[i];
+    return astar(
+        context, starts[i],
+        [&board](const State& s) { return s.successors(board); },
+        [](const State& s) -> bool { return s.is_goal(); },
+        [&board](const State& s) -> int { return s.heuristic(board); },
+        [](const State&, const State&) -> int { return 1; });
+  };
+  auto fresh_corpus = [&] {
+    for (std::size_t i = 0; i < starts.size(); i++) {
+      Context context({}, {}, &counter);
+      sink = sink + solve_in(context, i)->size();
+    }
+  };
+  Context reused({}, {}, &counter);
+  auto reused_corpus = [&] {
+    for (std::size_t i = 0; i < starts.size(); i++) {
+      sink = sink + solve_in(reused, i)->size();
+    }
+  };
+  results.push_back({"astar_corpus/fresh_context",
+                     measure(*options, starts.size(), fresh_corpus)});
+  results.push_back({"astar_corpus/reused_context",
+                     measure(*options, starts.size(), reused_corpus)});
+
+  auto upstream_calls = [&](const std::function<void()>& body) {
+    const std::size_t before = counter.allocations + counter.deallocations;
+    body();
+    return static_cast<double>(counter.allocations + counter.deallocations -
+                               before) /
+           static_cast<double>(starts.size());
+  };
+  std::cerr << "upstream allocator calls per solve: fresh context "
+            << upstream_calls(fresh_corpus) << ", reused context "
+            << upstream_calls(reused_corpus) << '\n';
+
+  // tear down after the largest search: destroying a context against
+  // resetting it for the next search
+  {
+    using clock = std::chrono::steady_clock;
+    const std::size_t hardest = starts.size() - 1;
+    constexpr int RUNS = 16;
+    clock::duration destroy{};
+    clock::duration reset{};
+    for (int r = 0; r < RUNS; r++) {
+      auto context = std::make_unique<Context>(std::hash<State>{},
+                                              std::equal_to<State>{}, &counter);
+      // the first reset grows the arena buffer to fit the whole search
+      sink = sink + solve_in(*context, hardest)->size();
+      context->clear();
+      sink = sink + solve_in(*context, hardest)->size();
+      auto start = clock::now();
+      context->clear();
+      reset += clock::now() - start;
+      sink = sink + solve_in(*context, hardest)->size();
+      start = clock::now();
+      context.reset();
+      destroy += clock::now() - start;
+    }
+    using us = std::chrono::duration<double, std::micro>;
+    std::cerr << "context teardown after " << CORPUS[hardest].name
+              << ": reset " << us(reset).count() / RUNS << " us, destroy "
+              << us(destroy).count() / RUNS << " us\n";
+  }
+
+  const auto baseline = options->baseline_path.empty()
+                            ? std::map<std::string, double>{}
+                            : load_results(options->baseline_path);
+  bool regression = false;
+  std::cout << "name,ns_per_call,calls_per_sec";
+  if (!baseline.empty()) std::cout << ",baseline_ns,change_pct,status";
+  std::cout << '\n';
+  for (const Result& result : results) {
+    std::cout << result.name << ',' << result.ns_per_call << ','
+              << 1e9 / result.ns_per_call;
+    if (!baseline.empty()) {
+      const auto it = baseline.find(result.name);
+      if (it == baseline.end()) {
+        std::cout << ",,,new";
+      } else {
+        const double change = (result.ns_per_call / it->second - 1.0) * 100.0;
+        const bool slower = change > options->threshold_pct;
+        regression = regression || slower;
+        std::cout << ',' << it->second << ',' << change << ','
+                  << (slower ? "regression" : "ok");
+      }
+    }
+    std::cout << '\n';
+  }
+
+  if (!options->save_path.empty()) {
+    std::ofstream out(options->save_path);
+    out << "name,ns_per_call\n";
+    for (const Result& result : results) {
+      out << result.name << ',' << result.ns_per_call << '\n';
+    }
+  }
+  return wrong_cost || regression ? 1 : 0;
+}
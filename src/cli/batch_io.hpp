@@ -0,0 +1,123 @@
+#pragma once
+
+/**
+ * @brief text format and streaming driver of the batch mode
+ * @paragraph
+ * One puzzle per line: the pawn position followed by eight two-digit tokens
+ * for the tiles A to H, each the tile's position then its orientation, e.g.
+ * `9 41 73 13 23 83 32 64 92`. The water takes the one free position. Blank
+ * lines and lines starting with '#' are skipped.
+ * @paragraph
+ * One result line per puzzle, in input order: the cost followed by the moves
+ * (e.g. `11 pawn:up C:left ...`), `-1` if the puzzle has no solution, or
+ * `invalid` if the line could not be parsed.
+ */
+
+#include <algorithm>
+#include <batch.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <types.hpp>
+#include <utility>
+#include <vector>
+
+/// @brief result line of a solution, without the newline
+std::string format_solution(const Solution& solution) {
+  if (!solution) return "-1";
+  std::string line = std::to_string(solution->size() - 1);
+  for (std::size_t i = 1; i < solution->size(); i++) {
+    std::string action = (*solution)[i - 1].get_action((*solution)[i]);
+    std::erase(action, ' ');
+    line += ' ';
+    line += action;
+  }
+  return line;
+}
+
+/**
+ * @brief solves puzzles as they are read and writes results in input order
+ * @paragraph
+ * A reader thread parses lines ahead of the solver. The calling thread takes
+ * every line read so far (up to MAX_CHUNK) as one chunk, solves it on a
+ * @ref BatchSolver and writes the chunk's results. A chunk is never held
+ * back waiting for more input, so the solver can sit in a pipeline and
+ * answer a line before the next one is sent.
+ * @return process exit code
+ */
+int run_batch(std::istream& in, std::ostream& out, unsigned threads,
+              bool use_pdb) {
+  /// lines solved together at most, bounds the wait for the first result
+  constexpr std::size_t MAX_CHUNK = 256;
+  BatchSolver solver(threads, use_pdb);
+
+  std::mutex lock;
+  std::condition_variable line_ready;
+  /// parsed lines not yet solved, std::nullopt for an invalid line
+  std::deque<std::optional<Puzzle>> lines;
+  bool input_done = false;
+
+  std::thread reader([&] {
+    std::string line;
+    while (std::getline(in, line)) {
+      const auto first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '#') continue;
+      auto puzzle = parse_puzzle(line);
+      {
+        std::lock_guard guard(lock);
+        lines.push_back(std::move(puzzle));
+      }
+      line_ready.notify_one();
+    }
+    std::lock_guard guard(lock);
+    input_done = true;
+    line_ready.notify_one();
+  });
+
+  std::vector<std::optional<Puzzle>> chunk;
+  std::vector<Puzzle> puzzles;
+  while (true) {
+    chunk.clear();
+    {
+      std::unique_lock guard(lock);
+      line_ready.wait(guard, [&] { return !lines.empty() || input_done; });
+      if (lines.empty()) break;
+      while (!lines.empty() && chunk.size() < MAX_CHUNK) {
+        chunk.push_back(std::move(lines.front()));
+        lines.pop_front();
+      }
+    }
+    puzzles.clear();
+    for (const auto& puzzle : chunk) {
+      if (puzzle) puzzles.push_back(*puzzle);
+    }
+    const std::vector<Solution> solutions = solver.solve(puzzles);
+    std::size_t next = 0;
+    for (const auto& puzzle : chunk) {
+      out << (puzzle ? format_solution(solutions[next++]) : "invalid") << '\n';
+    }
+    out.flush();
+  }
+  reader.join();
+  return 0;
+}
+
+/// @brief batch mode on a file, or on stdin when path is empty or "-"
+int run_batch(const std::string& path, unsigned threads, bool use_pdb) {
+  if (path.empty() || path == "-") {
+    return run_batch(std::cin, std::cout, threads, use_pdb);
+  }
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "could not open " << path << '\n';
+    return 1;
+  }
+  return run_batch(file, std::cout, threads, use_pdb);
+}
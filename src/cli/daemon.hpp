@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @brief long-lived solver speaking a line protocol on stdin and stdout
+ * @paragraph
+ * A request is an id (any word) followed by a puzzle in the batch line
+ * format, e.g. `q1 9 41 73 13 23 83 32 64 92`. The answer is the id followed
+ * by a batch result line (`q1 11 pawn:left ...`, `q1 -1` or `q1 invalid`).
+ * Requests are solved concurrently, so answers can come back out of order;
+ * match them by id. Each answer is flushed as soon as it is ready.
+ * @paragraph
+ * The line `stats` answers `stats` followed by `key=value` counters: the
+ * requests answered, the board cache hits, misses and size, and the p50 and
+ * p99 latency in microseconds over the most recent requests, measured from
+ * reading the request to writing its answer.
+ * @paragraph
+ * Puzzles are answered from the @ref DistanceTable of their board, kept in a
+ * @ref BoardCache. The first request on a board pays for the table build
+ * (under a second); later requests on it take microseconds.
+ */
+
+#include <algorithm>
+#include <batch_io.hpp>
+#include <board_cache.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <thread_pool.hpp>
+#include <vector>
+
+/**
+ * @brief latency percentiles over a sliding window of requests
+ * @paragraph
+ * Not thread safe; the daemon updates and reads it under its output lock.
+ */
+class LatencyWindow {
+ public:
+  static constexpr std::size_t WINDOW = 10000;
+
+  void record(std::chrono::nanoseconds latency) {
+    if (samples.size() < WINDOW) {
+      samples.push_back(latency);
+    } else {
+      samples[next] = latency;
+    }
+    next = (next + 1) % WINDOW;
+    total++;
+  }
+
+  /// @brief number of requests recorded since the start
+  inline std::size_t count() const { return total; }
+
+  /// @brief the q-quantile (0 to 1) of the window in microseconds
+  double quantile_us(double q) const {
+    if (samples.empty()) return 0.0;
+    std::vector<std::chrono::nanoseconds> sorted = samples;
+    const auto k = static_cast<std::size_t>(
+        q * static_cast<double>(sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(),
+                     sorted.begin() + static_cast<std::ptrdiff_t>(k),
+                     sorted.end());
+    return std::chrono::duration<double, std::micro>(sorted[k]).count();
+  }
+
+ private:
+  std::vector<std::chrono::nanoseconds> samples;
+  std::size_t next = 0;
+  std::size_t total = 0;
+};
+
+/**
+ * @param threads    workers answering requests, 0 means one per hardware
+ * thread
+ * @param max_boards distance tables kept in the board cache
+ * @return process exit code
+ */
+int run_daemon(std::istream& in, std::ostream& out, unsigned threads,
+               std::size_t max_boards) {
+  using clock = std::chrono::steady_clock;
+  threads = worker_count(threads);
+
+  // workers already run in parallel, so every table is built on one thread
+  BoardCache cache(max_boards, 1);
+  LatencyWindow latency;
+
+  struct Job {
+    std::string id;
+    Puzzle puzzle;
+    clock::time_point received;
+  };
+  std::mutex lock;
+  std::condition_variable job_ready;
+  std::deque<Job> jobs;
+  bool input_done = false;
+  std::mutex out_lock;
+
+  auto answer = [&](const std::string& id, const std::string& result,
+                    clock::time_point received) {
+    std::lock_guard guard(out_lock);
+    out << id << ' ' << result << '\n';
+    out.flush();
+    latency.record(clock::now() - received);
+  };
+
+  auto work = [&] {
+    while (true) {
+      Job job;
+      {
+        std::unique_lock guard(lock);
+        job_ready.wait(guard, [&] { return !jobs.empty() || input_done; });
+        if (jobs.empty()) return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      const BoardCache::TablePtr table = cache.get(job.puzzle.tiles);
+      input_tile_data_t tiles = job.puzzle.tiles;
+      const State start = State::from_input(job.puzzle.pawn_pos, tiles);
+      answer(job.id, format_solution(table->solve(start)), job.received);
+    }
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (unsigned w = 0; w < threads; w++) workers.emplace_back(work);
+
+  std::string line;
+  while (std::getline(in, line)) {
+    const auto received = clock::now();
+    std::istringstream words(line);
+    std::string id;
+    if (!(words >> id) || id.starts_with('#')) continue;
+    if (id == "stats") {
+      std::lock_guard guard(out_lock);
+      out << "stats requests=" << latency.count() << " hits=" << cache.hits()
+          << " misses=" << cache.misses() << " boards=" << cache.size()
+          << " p50_us=" << latency.quantile_us(0.50)
+          << " p99_us=" << latency.quantile_us(0.99) << '\n';
+      out.flush();
+      continue;
+    }
+    std::string rest;
+    std::getline(words, rest);
+    const auto puzzle = parse_puzzle(rest);
+    if (!puzzle) {
+      answer(id, "invalid", received);
+      continue;
+    }
+    std::lock_guard guard(lock);
+    jobs.push_back(Job{std::move(id), *puzzle, received});
+    job_ready.notify_one();
+  }
+  {
+    std::lock_guard guard(lock);
+    input_done = true;
+  }
+  job_ready.notify_all();
+  for (std::thread& worker : workers) worker.join();
+  return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+ * @brief generator and census modes, both built on a @ref PuzzleGenerator
+ * @paragraph
+ * The generator prints puzzles of an exact optimal length in the batch line
+ * format, so they can be piped straight into `solver --batch`. A leading
+ * comment line (skipped by the batch reader) names the orientations, the
+ * depth and how many starts have that depth.
+ * @paragraph
+ * The census prints how many start positions of a board need each number of
+ * moves, from the same single distance table build.
+ */
+
+#include <batch_io.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <generator.hpp>
+#include <iostream>
+#include <optional>
+#include <options.hpp>
+#include <random>
+#include <types.hpp>
+
+/// random orientation sets tried before giving up on a depth
+constexpr int ORIENTATION_ATTEMPTS = 16;
+
+/// @brief tile data with the orientations of --orientations, or random ones
+template <typename Rng>
+input_tile_data_t cli_orientations(const CliOptions& options, Rng& rng) {
+  input_tile_data_t tiles{};
+  std::uniform_int_distribution<int> orientation(1, 4);
+  for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+       t <= static_cast<std::size_t>(TileNames::H); t++) {
+    tiles[t].second = static_cast<std::int8_t>(
+        options.orientations.empty() ? orientation(rng)
+                                     : options.orientations[t - 1] - '0');
+  }
+  return tiles;
+}
+
+/// @brief the orientations of tiles A to H as eight digits
+void print_orientations(std::ostream& out, const input_tile_data_t& tiles) {
+  for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+       t <= static_cast<std::size_t>(TileNames::H); t++) {
+    out << static_cast<int>(tiles[t].second);
+  }
+}
+
+/// @return process exit code
+int run_generate(const CliOptions& options) {
+  std::mt19937_64 rng(options.seed ? *options.seed : std::random_device{}());
+
+  // random orientations: draw sets until one has a start at the depth
+  std::optional<PuzzleGenerator> generator;
+  input_tile_data_t tiles{};
+  int depth = 0;
+  for (int attempt = 0; attempt < ORIENTATION_ATTEMPTS; attempt++) {
+    tiles = cli_orientations(options, rng);
+    generator.emplace(tiles, options.threads);
+    depth = options.depth ? static_cast<int>(*options.depth)
+                          : generator->max_depth();
+    if (generator->count(depth) > 0 || !options.orientations.empty()) break;
+  }
+
+  std::cout << "# orientations ";
+  print_orientations(std::cout, tiles);
+  if (generator->count(generator->max_depth()) == 0) {
+    std::cout << ", no solvable start\n";
+    return 1;
+  }
+  std::cout << ", depth " << depth << ", " << generator->count(depth)
+            << " starts, hardest " << generator->max_depth() << '\n';
+
+  for (const Puzzle& puzzle : generator->sample(depth, options.count, rng)) {
+    std::cout << format_puzzle(puzzle) << '\n';
+  }
+  return generator->count(depth) == 0 ? 1 : 0;
+}
+
+/// @return process exit code
+int run_census(const CliOptions& options) {
+  std::mt19937_64 rng(options.seed ? *options.seed : std::random_device{}());
+  const input_tile_data_t tiles = cli_orientations(options, rng);
+
+  const auto start = std::chrono::steady_clock::now();
+  const Census census = PuzzleGenerator(tiles, options.threads).census();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::size_t solvable = 0;
+  for (std::size_t n : census.histogram) solvable += n;
+  std::cout << "orientations  ";
+  print_orientations(std::cout, tiles);
+  std::cout << "\nstarts        " << solvable + census.unsolvable
+            << "\nsolvable      " << solvable
+            << "\nunsolvable    " << census.unsolvable
+            << "\nmax depth     " << census.max_depth
+            << "\ntime          " << elapsed.count() << " s\n\nmoves,starts\n";
+  for (std::size_t d = 0; d < census.histogram.size(); d++) {
+    if (census.histogram[d] != 0) {
+      std::cout << d << ',' << census.histogram[d] << '\n';
+    }
+  }
+  return 0;
+}
@@ -1,12 +1,30 @@
+#include <batch_io.hpp>
 #include <board.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <daemon.hpp>
+#include <distance_db.hpp>
+#include <generate.hpp>
+#include <goal_seeds.hpp>
 #include <input.hpp>
 #include <iostream>
+#include <options.hpp>
+#include <pattern_db.hpp>
 #include <renderer.hpp>
 #include <solver.hpp>
 
-int main() {
+int main(int argc, char** argv) {
+  auto options = parse_args(argc, argv);
+  if (!options) return 1;
+  if (options->batch) {
+    return run_batch(options->batch_file, options->threads, options->use_pdb);
+  }
+  if (options->daemon) {
+    return run_daemon(std::cin, std::cout, options->threads, options->cache);
+  }
+  if (options->generate) return run_generate(*options);
+  if (options->census) return run_census(*options);
+
 // #define DEBUG_INPUT
 #ifdef DEBUG_INPUT
   // test case 1
@@ -49,9 +67,19 @@ int main() {
       State::from_input(static_cast<int8_t>(input_pawn_pos), input_tile_infos);
 
   auto successors = [&board](const State& s) { return s.successors(board); };
+  // A* searches canonical states, its path is relabelled afterwards
+  auto canonical_successors = [&board](const State& s) {
+    return s.canonical_successors(board);
+  };
+  const State canonical_start = initial_state.canonical(board);
   auto goal_test = [](const State& s) -> bool { return s.is_goal(); };
-  auto heuristics = [&board](const State& s) -> int {
-    return static_cast<int>(s.heuristic(board));
+  std::optional<PatternDatabase> pdb;
+  const auto pdb_start = std::chrono::steady_clock::now();
+  if (options->use_pdb) pdb.emplace(board);
+  const auto pdb_time = std::chrono::steady_clock::now() - pdb_start;
+  auto heuristics = [&board, &pdb](const State& s) -> int {
+    int h = static_cast<int>(s.heuristic(board));
+    return pdb ? std::max(h, pdb->heuristic(s)) : h;
   };
   auto cost_between = [](const State& a, const State& b) -> int {
     (void)a;
@@ -59,11 +87,63 @@ int main() {
     return 1;
   };
   auto st = std::chrono::high_resolution_clock::now();
-  auto first_successor_deb = successors(initial_state);
-  auto result =
-      astar(initial_state, successors, goal_test, heuristics, cost_between);
+  std::optional<std::vector<State>> result;
+  SearchStats stats;
+  bool searched = false;   // stats only cover the plain A* search
+  bool canonical = false;  // result is a path of canonical states
+  if (!options->db_dir.empty()) {
+    auto db =
+        DistanceDatabase::load_or_build(options->db_dir, input_tile_infos);
+    if (!db) {
+      std::cout << "could not open or build the distance database in "
+                << options->db_dir << '\n';
+      return -1;
+    }
+    result = db->solve(initial_state);
+  } else if (pdb && pdb->is_dead_end(initial_state)) {
+    result = std::nullopt;
+  } else if (options->use_bidir) {
+    GoalSeeds seeds(board, initial_state);
+    auto predecessors = [&board](const State& s) {
+      return s.predecessors(board);
+    };
+    auto back_heuristics = [&seeds](const State& s) -> int {
+      return seeds.back_heuristic(s);
+    };
+    result = bidirectional_astar<BucketOpenList>(
+        initial_state, seeds, seeds.max_level(), successors, predecessors,
+        goal_test, heuristics, back_heuristics, cost_between);
+  } else if (options->stats) {
+    SearchContext<State, BucketOpenList> context;
+    result = astar(context, canonical_start, canonical_successors, goal_test,
+                   heuristics, cost_between, stats);
+    searched = true;
+    canonical = true;
+  } else {
+    // unit costs and a small integer heuristic: bucketed open list
+    result = astar<BucketOpenList>(canonical_start, canonical_successors,
+                                   goal_test, heuristics, cost_between);
+    canonical = true;
+  }
+  if (result && canonical) {
+    *result = relabel_path(board, initial_state, *result);
+  }
   auto end = std::chrono::high_resolution_clock::now();
 
+  if (options->stats) {
+    std::cout << "\nsearch stats:\n";
+    if (pdb) {
+      std::cout << "pdb build time "
+                << std::chrono::duration<double, std::milli>(pdb_time).count()
+                << " ms\n";
+    }
+    if (searched) {
+      std::cout << stats << '\n';
+    } else {
+      std::cout << "--stats only covers the plain A* search\n\n";
+    }
+  }
+
   if (result) {
     std::cout << "Found path of cost: " << result->size() - 1 << '\n';
     if (result->size() == 0) {
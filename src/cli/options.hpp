@@ -0,0 +1,141 @@
+#pragma once
+
+/**
+ * @brief command line options of the solver binary
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <system_error>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct CliOptions {
+  /// directory of the on-disk distance databases, empty when not used
+  std::string db_dir;
+  /// combine the heuristic with a per-board pattern database
+  bool use_pdb = false;
+  /// search from both ends, see bidirectional_astar
+  bool use_bidir = false;
+  /// print the SearchStats of the A* search
+  bool stats = false;
+  /// solve puzzle lines without the interactive input and the window
+  bool batch = false;
+  /// file of puzzle lines, empty or "-" for stdin
+  std::string batch_file;
+  /// answer id-tagged puzzle lines from stdin until it closes
+  bool daemon = false;
+  /// distance tables kept by the daemon
+  unsigned cache = 16;
+  /// worker threads of the batch and daemon modes and of table builds, 0
+  /// means one per hardware thread
+  unsigned threads = 0;
+  /// print puzzles of a given optimal length instead of solving
+  bool generate = false;
+  /// print the histogram of optimal lengths of all starts of a board
+  bool census = false;
+  /// optimal length of generated puzzles, std::nullopt for the hardest
+  std::optional<unsigned> depth;
+  /// number of generated puzzles
+  unsigned count = 1;
+  /// orientations of tiles A to H as eight digits, empty for random ones
+  std::string orientations;
+  /// seed of the generator, random when not given
+  std::optional<unsigned> seed;
+};
+
+void print_usage(std::string_view program) {
+  std::cout << "usage: " << program << " [options]\n"
+            << "  --db <dir>       solve with the distance database in <dir>,\n"
+            << "                   building the board's file if missing\n"
+            << "  --pdb            add a pattern-database heuristic to A*\n"
+            << "  --bidir          bidirectional A* towards the goal states\n"
+            << "  --stats          print node counts and timings of A*\n"
+            << "  --batch [file]   solve one puzzle per line of file or stdin\n"
+            << "  --daemon         answer '<id> <puzzle>' lines on stdin,\n"
+            << "                   'stats' prints counters\n"
+            << "  --cache <n>      boards cached by --daemon (default 16)\n"
+            << "  --threads <n>    worker threads of --batch and --daemon\n"
+            << "                   (default: all)\n"
+            << "  --generate <d>   print puzzles solved in exactly d moves,\n"
+            << "                   or the hardest ones for d = max\n"
+            << "  --count <n>      number of generated puzzles (default 1)\n"
+            << "  --census         print how many starts of the board need\n"
+            << "                   each number of moves\n"
+            << "  --orientations <abcdefgh>\n"
+            << "                   orientations of tiles A to H for\n"
+            << "                   --generate and --census (default: random)\n"
+            << "  --seed <n>       random seed of --generate and --census\n"
+            << "  --help           show this message\n";
+}
+
+/// @brief parses a whole argument as an unsigned number
+bool parse_unsigned(std::string_view arg, unsigned& value) {
+  const auto [end, ec] =
+      std::from_chars(arg.data(), arg.data() + arg.size(), value);
+  return ec == std::errc{} && end == arg.data() + arg.size();
+}
+
+/// @brief eight orientations 1 to 4, one digit per tile A to H
+bool valid_orientations(std::string_view arg) {
+  return arg.size() == 8 && std::ranges::all_of(arg, [](char c) {
+           return c >= '1' && c <= '4';
+         });
+}
+
+/// @brief parses argv, prints usage and returns std::nullopt on bad input
+std::optional<CliOptions> parse_args(int argc, char** argv) {
+  CliOptions options;
+  const std::string_view program = argc > 0 ? argv[0] : "solver";
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    unsigned number = 0;  // value of a numeric option
+    if (arg == "--db" && i + 1 < argc) {
+      options.db_dir = argv[++i];
+    } else if (arg == "--pdb") {
+      options.use_pdb = true;
+    } else if (arg == "--bidir") {
+      options.use_bidir = true;
+    } else if (arg == "--stats") {
+      options.stats = true;
+    } else if (arg == "--batch") {
+      options.batch = true;
+      // the file is optional, stdin is read without one
+      if (i + 1 < argc && !std::string_view(argv[i + 1]).starts_with("--")) {
+        options.batch_file = argv[++i];
+      }
+    } else if (arg == "--daemon") {
+      options.daemon = true;
+    } else if (arg == "--cache" && i + 1 < argc &&
+               parse_unsigned(argv[i + 1], options.cache)) {
+      i++;
+    } else if (arg == "--threads" && i + 1 < argc &&
+               parse_unsigned(argv[i + 1], options.threads)) {
+      i++;
+    } else if (arg == "--generate" && i + 1 < argc &&
+               (argv[i + 1] == std::string_view("max") ||
+                parse_unsigned(argv[i + 1], number))) {
+      options.generate = true;
+      if (argv[++i] != std::string_view("max")) options.depth = number;
+    } else if (arg == "--census") {
+      options.census = true;
+    } else if (arg == "--count" && i + 1 < argc &&
+               parse_unsigned(argv[i + 1], options.count)) {
+      i++;
+    } else if (arg == "--orientations" && i + 1 < argc &&
+               valid_orientations(argv[i + 1])) {
+      options.orientations = argv[++i];
+    } else if (arg == "--seed" && i + 1 < argc &&
+               parse_unsigned(argv[i + 1], number)) {
+      options.seed = number;
+      i++;
+    } else {
+      if (arg != "--help") std::cout << "unknown option: " << arg << '\n';
+      print_usage(program);
+      return std::nullopt;
+    }
+  }
+  return options;
+}
@@ -9,17 +9,38 @@
  */
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <array>
 #include <board.hpp>
 #include <cassert>
 #include <chrono>
-#include <memory>
+#include <cmath>
 #include <types.hpp>
 #include <vector>
 
 namespace pieces {
 
-class CompositeShape : public sf::Drawable, public sf::Transformable {
+/// @brief appends the two triangles of an axis-aligned rectangle, moved by
+/// transform
+void appendRect(std::vector<sf::Vertex>& vertices,
+                const sf::Transform& transform, sf::Vector2f position,
+                sf::Vector2f size, sf::Color color) {
+  const sf::Vector2f corners[4] = {position,
+                                   position + sf::Vector2f(size.x, 0.f),
+                                   position + size,
+                                   position + sf::Vector2f(0.f, size.y)};
+  for (const int corner : {0, 1, 2, 0, 2, 3}) {
+    vertices.emplace_back(transform.transformPoint(corners[corner]), color);
+  }
+}
+
+/**
+ * @brief a piece design as colored rectangles in tile coordinates
+ * @paragraph
+ * A design is only a recipe: bake() turns it into triangles once, and the
+ * renderer then draws a tile by copying those vertices to the tile's cell.
+ */
+class CompositeShape {
   std::vector<sf::RectangleShape> parts;
   std::vector<sf::Vector2f> localOffsets;
 
@@ -29,34 +50,39 @@ class CompositeShape : public sf::Drawable, public sf::Transformable {
     localOffsets.push_back(offset);
   }
 
-  void setPosition(const sf::Vector2f& pos) {
-    sf::Transformable::setPosition(pos);
-    updatePartsTransform();
-  }
-
-  void setRotation(float angle) {
-    sf::Transformable::setRotation(angle);
-    updatePartsTransform();
-  }
-
- private:
-  void updatePartsTransform() {
-    // translate to the requested position, then rotate about the tile center
-    // (100,100)
+  /// @brief triangles of all parts, rotated by angle degrees about the tile
+  /// center (100,100) of the 200x200 tile
+  std::vector<sf::Vertex> bake(float angle) const {
     sf::Transform transform;
-    transform.translate(getPosition());
-    transform.rotate(getRotation(),
-                     {100.f, 100.f});  // center rotation for 200x200 tiles
+    transform.rotate(angle, {100.f, 100.f});
 
+    std::vector<sf::Vertex> vertices;
     for (std::size_t i = 0; i < parts.size(); ++i) {
-      sf::Vector2f worldPos = transform.transformPoint(localOffsets[i]);
-      parts[i].setPosition(worldPos);
-      parts[i].setRotation(getRotation());
+      const sf::RectangleShape& part = parts[i];
+      const sf::Vector2f size = part.getSize();
+      if (part.getFillColor() != sf::Color::Transparent) {
+        appendRect(vertices, transform, localOffsets[i], size,
+                   part.getFillColor());
+      }
+      // the outline as four bands, inside the part for a negative thickness
+      const float thickness = part.getOutlineThickness();
+      if (thickness == 0.f) continue;
+      const float band = std::abs(thickness);
+      const float grow = std::max(thickness, 0.f);
+      const sf::Vector2f outer = localOffsets[i] - sf::Vector2f(grow, grow);
+      const sf::Vector2f outer_size = size + sf::Vector2f(2 * grow, 2 * grow);
+      const sf::Color color = part.getOutlineColor();
+      appendRect(vertices, transform, outer, {outer_size.x, band}, color);
+      appendRect(vertices, transform,
+                 outer + sf::Vector2f(0.f, outer_size.y - band),
+                 {outer_size.x, band}, color);
+      appendRect(vertices, transform, outer + sf::Vector2f(0.f, band),
+                 {band, outer_size.y - 2 * band}, color);
+      appendRect(vertices, transform,
+                 outer + sf::Vector2f(outer_size.x - band, band),
+                 {band, outer_size.y - 2 * band}, color);
     }
-  }
-
-  void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
-    for (const auto& p : parts) target.draw(p, states);
+    return vertices;
   }
 };
 
@@ -182,154 +208,232 @@ CompositeShape makeWaterShape() {
 
 /**
  * @brief RenderBoard class for handling SFML based rendering
+ * @paragraph
+ * Every piece design is baked into triangles once, in the constructor; a
+ * frame is the board, the nine tiles and the pawn copied into one vertex
+ * array and sent to the GPU in a single draw call. Stepping to another state
+ * slides the moved tile or the pawn there over TRANSITION, redrawing at the
+ * display refresh rate; an idle window sleeps until the next event.
  */
 class RenderBoard {
  public:
   RenderBoard(const input_tile_data_t& tiledata)
       : window(sf::VideoMode(800, 800), "Temple Trap Solver Visualization") {
-    // build configuration prototypes for each tile type (1..9)
+    window.setVerticalSyncEnabled(true);
+    // bake the design of each tile type (1..9) in its orientation
     for (int i = 1; i <= 9; i++) {
       TileNames name = static_cast<TileNames>(i);
+      pieces::CompositeShape shape;
       switch (name) {
         case TileNames::A:
         case TileNames::B:
-          configuration[i] = std::make_unique<pieces::CompositeShape>(
-              pieces::makeLShapedTop());
+          shape = pieces::makeLShapedTop();
           break;
         case TileNames::C:
-          configuration[i] = std::make_unique<pieces::CompositeShape>(
-              pieces::makePipeShapedTop());
+          shape = pieces::makePipeShapedTop();
           break;
         case TileNames::D:
         case TileNames::E:
-          configuration[i] = std::make_unique<pieces::CompositeShape>(
-              pieces::makeStairShapeBottom());
+          shape = pieces::makeStairShapeBottom();
           break;
         case TileNames::F:
         case TileNames::G:
         case TileNames::H:
-          configuration[i] = std::make_unique<pieces::CompositeShape>(
-              pieces::makeLShapedBottom());
+          shape = pieces::makeLShapedBottom();
           break;
         case TileNames::Water:
-          configuration[i] = std::make_unique<pieces::CompositeShape>(
-              pieces::makeWaterShape());
+          shape = pieces::makeWaterShape();
           break;
         default:
           assert(false && "unexpected code path");
           break;
       }
       float rotation = RenderBoard::get_angle(tiledata[i].second);
-      configuration[i]->setRotation(rotation);
+      configuration[i] = shape.bake(rotation);
+    }
+
+    // board rectangle (650x650) positioned at BOARD_ORIGIN, and its opening
+    const sf::Transform identity;
+    pieces::appendRect(board, identity, BOARD_ORIGIN, {650.f, 650.f},
+                       pieces::BoardColor);
+    pieces::appendRect(board, identity, BOARD_ORIGIN + sf::Vector2f(0.f, 37.5f),
+                       {50.f, 175.f}, pieces::Green);
+
+    // pawn disc as a fan of triangles around (0,0)
+    // #rgba(10, 0, 48, 1)
+    const sf::Color pawn_color(10, 0, 30);
+    const float pi = 3.14159265f;
+    for (int k = 0; k < PAWN_SEGMENTS; k++) {
+      const float a0 = 2 * pi * static_cast<float>(k) / PAWN_SEGMENTS;
+      const float a1 = 2 * pi * static_cast<float>(k + 1) / PAWN_SEGMENTS;
+      pawn.emplace_back(sf::Vector2f(0.f, 0.f), pawn_color);
+      pawn.emplace_back(
+          sf::Vector2f(PAWN_RADIUS * std::cos(a0), PAWN_RADIUS * std::sin(a0)),
+          pawn_color);
+      pawn.emplace_back(
+          sf::Vector2f(PAWN_RADIUS * std::cos(a1), PAWN_RADIUS * std::sin(a1)),
+          pawn_color);
     }
   }
 
   void draw_states(const std::vector<State>& states) {
+    using clock = std::chrono::steady_clock;
     int indx = 0;
+    // the state the current transition started from
+    int from = 0;
+    auto transition_start = clock::now();
     bool need_redraw = true;
     // repeat control
     const int MIN_MILLISECONDS_DELAY = 500;
 
-    auto last_action_time = std::chrono::steady_clock::time_point::min();
+    auto last_action_time = clock::time_point::min();
     bool leftHeld = false, rightHeld = false;
 
     while (window.isOpen()) {
       sf::Event event;
       indx = std::clamp(indx, 0, static_cast<int>(states.size()) - 1);
 
-      if (need_redraw) {
-        this->draw_state(states[indx]);
+      const auto since_start = clock::now() - transition_start;
+      const bool animating = from != indx && since_start < TRANSITION;
+      if (animating) {
+        const float progress =
+            std::chrono::duration<float>(since_start) / TRANSITION;
+        this->draw_state(states[from], states[indx], progress);
+      } else if (need_redraw || from != indx) {
+        this->draw_state(states[indx], states[indx], 1.f);
+        from = indx;
         need_redraw = false;
       }
 
-      if (window.waitEvent(event)) {
-        int arrow_intent = 0;
-
-        do {
-          if (event.type == sf::Event::Closed) {
-            window.close();
-          } else if (event.type == sf::Event::KeyPressed) {
-            if (event.key.code == sf::Keyboard::Left) {
-              arrow_intent = -1;
-              leftHeld = true;
-            } else if (event.key.code == sf::Keyboard::Right) {
-              arrow_intent = +1;
-              rightHeld = true;
-            }
-          } else if (event.type == sf::Event::KeyReleased) {
-            if (event.key.code == sf::Keyboard::Left) {
-              leftHeld = false;
-              last_action_time = std::chrono::steady_clock::time_point::min();
-            } else if (event.key.code == sf::Keyboard::Right) {
-              rightHeld = false;
-              last_action_time = std::chrono::steady_clock::time_point::min();
-            }
-          } else if (event.type == sf::Event::Resized) {
-            need_redraw = true;
-          }
-
-        } while (window.pollEvent(event));
-
-        if (arrow_intent != 0) {
-          auto now = std::chrono::steady_clock::now();
-          bool canAct = false;
-          if (last_action_time ==
-              std::chrono::steady_clock::time_point::min()) {
-            canAct = true;
-          } else {
-            auto elapsed_ms =
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - last_action_time)
-                    .count();
-            if (elapsed_ms >= MIN_MILLISECONDS_DELAY) canAct = true;
+      // while a transition plays, display() paces the loop to the refresh
+      // rate and events are only polled
+      int arrow_intent = 0;
+      auto handle = [&](const sf::Event& e) {
+        if (e.type == sf::Event::Closed) {
+          window.close();
+        } else if (e.type == sf::Event::KeyPressed) {
+          if (e.key.code == sf::Keyboard::Left) {
+            arrow_intent = -1;
+            leftHeld = true;
+          } else if (e.key.code == sf::Keyboard::Right) {
+            arrow_intent = +1;
+            rightHeld = true;
           }
-          if (canAct) {
-            indx += arrow_intent;
-            need_redraw = true;
-            last_action_time = std::chrono::steady_clock::now();
+        } else if (e.type == sf::Event::KeyReleased) {
+          if (e.key.code == sf::Keyboard::Left) {
+            leftHeld = false;
+            last_action_time = clock::time_point::min();
+          } else if (e.key.code == sf::Keyboard::Right) {
+            rightHeld = false;
+            last_action_time = clock::time_point::min();
           }
+        } else if (e.type == sf::Event::Resized) {
+          need_redraw = true;
         }
-
+      };
+      if (animating) {
+        while (window.pollEvent(event)) handle(event);
+      } else if (window.waitEvent(event)) {
+        do {
+          handle(event);
+        } while (window.pollEvent(event));
       } else {
         std::cerr << "error occured in sf::waitEvent\n";
       }
+
+      if (arrow_intent != 0) {
+        auto now = clock::now();
+        bool canAct = false;
+        if (last_action_time == clock::time_point::min()) {
+          canAct = true;
+        } else {
+          auto elapsed_ms =
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  now - last_action_time)
+                  .count();
+          if (elapsed_ms >= MIN_MILLISECONDS_DELAY) canAct = true;
+        }
+        const int next = std::clamp(indx + arrow_intent, 0,
+                                    static_cast<int>(states.size()) - 1);
+        if (canAct && next != indx) {
+          // a transition still playing is cut short and the new one starts
+          // from the state it was heading to
+          from = indx;
+          indx = next;
+          transition_start = now;
+          last_action_time = now;
+        }
+      }
     }
   }
 
  private:
-  void draw_state(const State& state) {
-    window.clear(sf::Color(30, 30, 30));
-    drawBoard();
-
-    // draw tiles by mapping state.tiles[grid_index] -> tile type
-    for (int gridIndex = 1; gridIndex < 10; ++gridIndex) {
-      TileNames tileType = state.tiles[gridIndex];
-      // compute the top-left position inside the board for this grid cell
-      sf::Vector2f pos = get_position(static_cast<int8_t>(gridIndex));
-      // place the prototype for that tile type at the computed position
-      configuration[static_cast<int>(tileType)]->setPosition(pos);
-      window.draw(*configuration[static_cast<int>(tileType)]);
+  /**
+   * @brief draws the way from one state to the next, at progress 0 to 1
+   * @paragraph
+   * Tiles and the pawn are drawn between their places in from and to; the
+   * water is drawn at both places, so the cell a tile leaves and the cell it
+   * slides onto both show water under it. from == to draws a still state.
+   */
+  void draw_state(const State& from, const State& to, float progress) {
+    // ease in and out
+    const float t = progress * progress * (3.f - 2.f * progress);
+    auto between = [t](sf::Vector2f a, sf::Vector2f b) {
+      return a + sf::Vector2f((b.x - a.x) * t, (b.y - a.y) * t);
+    };
+
+    // cell of each tile type in both states
+    std::array<int8_t, static_cast<std::size_t>(TileNames::End)> cell_from{};
+    std::array<int8_t, static_cast<std::size_t>(TileNames::End)> cell_to{};
+    for (int8_t gridIndex = 1; gridIndex < 10; ++gridIndex) {
+      cell_from[static_cast<std::size_t>(from.tile(gridIndex))] = gridIndex;
+      cell_to[static_cast<std::size_t>(to.tile(gridIndex))] = gridIndex;
+    }
+
+    frame.clear();
+    append(board, {0.f, 0.f});
+    const auto water = static_cast<std::size_t>(TileNames::Water);
+    append(configuration[water], get_position(cell_from[water]));
+    if (cell_from[water] != cell_to[water]) {
+      append(configuration[water], get_position(cell_to[water]));
     }
-    if (state.pawn_pos != 0) {
-      // draw pawn centered in its tile
-      sf::Vector2f pawnTilePos = get_position(state.pawn_pos);
-      float pawnRadius = 30.f;
-      sf::CircleShape pawn(pawnRadius);
-      // center the pawn inside the 200x200 tile
-      pawn.setPosition(pawnTilePos +
-                       sf::Vector2f(100.f - pawnRadius, 100.f - pawnRadius));
-      // #rgba(10, 0, 48, 1)
-      pawn.setFillColor(sf::Color(10, 0, 30));
-      window.draw(pawn);
+    for (std::size_t name = 1; name < water; name++) {
+      append(configuration[name], between(get_position(cell_from[name]),
+                                          get_position(cell_to[name])));
     }
+    // the pawn is hidden at rest on the goal, but seen walking to it
+    if (from.pawn_pos() != 0 || to.pawn_pos() != 0) {
+      append(pawn, between(get_pawn_center(from.pawn_pos()),
+                           get_pawn_center(to.pawn_pos())));
+    }
+
+    window.clear(sf::Color(30, 30, 30));
+    window.draw(frame);
     window.display();
   }
 
+  /// @brief appends baked vertices to the frame, moved by offset
+  void append(const std::vector<sf::Vertex>& vertices, sf::Vector2f offset) {
+    for (const sf::Vertex& v : vertices) {
+      frame.append(sf::Vertex(v.position + offset, v.color));
+    }
+  }
+
   sf::RenderWindow window;
 
-  std::array<std::unique_ptr<pieces::CompositeShape>,
-             static_cast<std::size_t>(TileNames::End)>
+  /// baked triangles of each tile type, in tile coordinates
+  std::array<std::vector<sf::Vertex>, static_cast<std::size_t>(TileNames::End)>
       configuration;
+  /// board and opening, in window coordinates
+  std::vector<sf::Vertex> board;
+  /// pawn disc centered on (0,0)
+  std::vector<sf::Vertex> pawn;
+  /// vertices of the frame being drawn, kept to reuse its storage
+  sf::VertexArray frame{sf::Triangles};
+
+  static constexpr std::chrono::milliseconds TRANSITION{200};
+  static constexpr int PAWN_SEGMENTS = 32;
+  static constexpr float PAWN_RADIUS = 30.f;
 
   const float PIECE_SIZE = 200.f;
   const sf::Vector2f BOARD_ORIGIN = {75.f,
@@ -372,16 +476,9 @@ class RenderBoard {
                         BOARD_ORIGIN.y + BOARD_OFFSET.y + cellY * PIECE_SIZE);
   }
 
-  void drawBoard() {
-    // board rectangle (650x650) positioned at BOARD_ORIGIN
-    sf::RectangleShape board({650.f, 650.f});
-    board.setFillColor(pieces::BoardColor);
-    board.setPosition(BOARD_ORIGIN);
-    window.draw(board);
-
-    sf::RectangleShape opening({50.f, 175.f});
-    opening.setFillColor(pieces::Green);
-    opening.setPosition(BOARD_ORIGIN + sf::Vector2f(0.f, 37.5f));
-    window.draw(opening);
+  /// @brief center of the pawn on pos, the middle of the opening for the goal
+  sf::Vector2f get_pawn_center(int8_t pos) const {
+    if (pos == 0) return BOARD_ORIGIN + sf::Vector2f(25.f, 125.f);
+    return get_position(pos) + sf::Vector2f(PIECE_SIZE / 2, PIECE_SIZE / 2);
   }
 };
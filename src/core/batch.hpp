@@ -0,0 +1,188 @@
+#pragma once
+
+/**
+ * @file batch.hpp
+ * @brief Solving many puzzles with reused search memory.
+ *
+ * A @ref Puzzle is a start position as the CLI reads it, checked by
+ * make_puzzle() and read from and written to text by parse_puzzle() and
+ * format_puzzle(). A @ref PuzzleSolver solves one puzzle at a time and keeps
+ * its search memory for the next; the WASM module keeps one for its
+ * lifetime. A @ref BatchSolver solves lists of puzzles on a
+ * @ref WorkStealingPool with one PuzzleSolver per worker and returns the
+ * results in input order; `solver --batch` runs on it.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <board.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <pattern_db.hpp>
+#include <solver.hpp>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread_pool.hpp>
+#include <types.hpp>
+#include <vector>
+
+/// @brief one puzzle: the pawn position and the tiles as read by the CLI
+struct Puzzle {
+  std::int8_t pawn_pos;
+  input_tile_data_t tiles;
+};
+
+/// @brief optimal path of a puzzle (start first), std::nullopt if unsolvable
+using Solution = std::optional<std::vector<State>>;
+
+/**
+ * @brief the puzzle of a pawn position and the tiles A to H, std::nullopt if
+ * they do not form a valid start
+ * @paragraph
+ * tiles holds position then orientation for each of A to H. Positions must be
+ * distinct cells 1 to 9 and orientations 1 to 4; the water takes the one free
+ * cell. As in the interactive input, the pawn starts on one of the tiles D
+ * to H.
+ */
+inline std::optional<Puzzle> make_puzzle(int pawn,
+                                         const std::array<int, 16>& tiles) {
+  if (pawn < 1 || pawn > 9) return std::nullopt;
+  Puzzle puzzle{static_cast<std::int8_t>(pawn), {}};
+  unsigned used = 1;  // bit per cell, the goal cell is never free
+  for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+       t <= static_cast<std::size_t>(TileNames::H); t++) {
+    const int pos = tiles[2 * (t - 1)];
+    const int orientation = tiles[2 * (t - 1) + 1];
+    if (pos < 1 || pos > 9 || (used >> pos & 1u) != 0 || orientation < 1 ||
+        orientation > 4) {
+      return std::nullopt;
+    }
+    used |= 1u << pos;
+    puzzle.tiles[t] = {static_cast<std::int8_t>(pos),
+                       static_cast<std::int8_t>(orientation)};
+  }
+  const auto water = static_cast<std::int8_t>(std::countr_one(used));
+  puzzle.tiles[static_cast<std::size_t>(TileNames::Water)] = {water, 0};
+
+  for (TileNames name :
+       {TileNames::Water, TileNames::A, TileNames::B, TileNames::C}) {
+    if (puzzle.tiles[static_cast<std::size_t>(name)].first == pawn) {
+      return std::nullopt;
+    }
+  }
+  return puzzle;
+}
+
+/**
+ * @brief parses one puzzle line, std::nullopt if it is not a valid puzzle
+ * @paragraph
+ * The line is the pawn position followed by eight two-digit tokens for the
+ * tiles A to H, each the tile's position then its orientation, e.g.
+ * `9 41 73 13 23 83 32 64 92`. This is the line format of `solver --batch`,
+ * the daemon and the generator.
+ */
+inline std::optional<Puzzle> parse_puzzle(std::string_view line) {
+  std::istringstream in{std::string(line)};
+  int pawn = 0;
+  if (!(in >> pawn)) return std::nullopt;
+
+  std::array<int, 16> tiles{};
+  for (std::size_t t = 0; t < 8; t++) {
+    std::string token;
+    if (!(in >> token) || token.size() != 2) return std::nullopt;
+    tiles[2 * t] = token[0] - '0';
+    tiles[2 * t + 1] = token[1] - '0';
+  }
+  std::string rest;
+  if (in >> rest) return std::nullopt;
+  return make_puzzle(pawn, tiles);
+}
+
+/// @brief puzzle line of a puzzle, the inverse of parse_puzzle
+inline std::string format_puzzle(const Puzzle& puzzle) {
+  std::string line = std::to_string(puzzle.pawn_pos);
+  for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+       t <= static_cast<std::size_t>(TileNames::H); t++) {
+    line += ' ';
+    line += static_cast<char>('0' + puzzle.tiles[t].first);
+    line += static_cast<char>('0' + puzzle.tiles[t].second);
+  }
+  return line;
+}
+
+/**
+ * @brief solves one puzzle at a time, reusing its search memory
+ * @paragraph
+ * Uses the same search as the interactive solver: A* with the bucketed open
+ * list and the board heuristic, optionally combined with a per-board
+ * @ref PatternDatabase, over canonical states (see State::canonical). Not
+ * thread safe; give every thread its own solver.
+ */
+class PuzzleSolver {
+ public:
+  explicit PuzzleSolver(bool pattern_db = false) : use_pdb(pattern_db) {}
+
+  Solution solve(const Puzzle& puzzle) {
+    input_tile_data_t tiles = puzzle.tiles;
+    const Board board(tiles);
+    const State start = State::from_input(puzzle.pawn_pos, tiles);
+
+    std::optional<PatternDatabase> pdb;
+    if (use_pdb) {
+      pdb.emplace(board);
+      if (pdb->is_dead_end(start)) return std::nullopt;
+    }
+    // search canonical states, then name the tiles the player really moves
+    auto successors = [&board](const State& s) {
+      return s.canonical_successors(board);
+    };
+    auto goal_test = [](const State& s) -> bool { return s.is_goal(); };
+    auto heuristics = [&board, &pdb](const State& s) -> int {
+      int h = s.heuristic(board);
+      return pdb ? std::max(h, pdb->heuristic(s)) : h;
+    };
+    auto cost_between = [](const State&, const State&) -> int { return 1; };
+    Solution path = astar(context, start.canonical(board), successors,
+                          goal_test, heuristics, cost_between);
+    if (path) *path = relabel_path(board, start, *path);
+    return path;
+  }
+
+ private:
+  bool use_pdb;
+  SearchContext<State, BucketOpenList> context;
+};
+
+/**
+ * @brief solves lists of puzzles on a @ref WorkStealingPool
+ * @paragraph
+ * A worker stuck on one deep puzzle does not hold up the easy puzzles queued
+ * behind it: the others steal them. Every worker owns one @ref PuzzleSolver,
+ * kept between calls, so its search memory is reused for every puzzle it
+ * solves.
+ */
+class BatchSolver {
+ public:
+  /// @param threads number of workers, 0 means one per hardware thread
+  explicit BatchSolver(unsigned threads = 0, bool pattern_db = false)
+      : pool(threads), solvers(pool.size(), PuzzleSolver(pattern_db)) {}
+
+  inline unsigned threads() const { return pool.size(); }
+
+  /// @brief solutions of all puzzles, in the order of the input
+  std::vector<Solution> solve(const std::vector<Puzzle>& puzzles) {
+    std::vector<Solution> solutions(puzzles.size());
+    pool.run(puzzles.size(), [&](unsigned worker, std::size_t index) {
+      solutions[index] = solvers[worker].solve(puzzles[index]);
+    });
+    return solutions;
+  }
+
+ private:
+  WorkStealingPool pool;
+  /// one per worker, kept between batches
+  std::vector<PuzzleSolver> solvers;
+};
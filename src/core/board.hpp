@@ -9,9 +9,11 @@
  */
 
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <format>
 #include <iostream>
 #include <types.hpp>
 #include <utility>
@@ -117,18 +119,132 @@ class Board {
         Floor::Top;
     this->grid_info[(static_cast<std::size_t>(TileNames::Goal))].openings = {
         {{Directions::Right, Floor::Top}, {Directions::Right, Floor::Top}}};
+    build_move_tables();
+    build_tile_classes(input_data);
   }
   Floor get_floor(const TileNames name) const {
     return grid_info[static_cast<std::size_t>(name)].floor;
   }
 
-  std::array<std::pair<Directions, Floor>, 2> get_openings(
+  const std::array<std::pair<Directions, Floor>, 2>& get_openings(
       const TileNames name) const {
     return grid_info[static_cast<std::size_t>(name)].openings;
   }
 
+  /// @brief bitmask (1 << Directions) of the sides a tile has an opening on
+  inline std::uint8_t get_exits(const TileNames name) const {
+    return exits[static_cast<std::size_t>(name)];
+  }
+
+  /**
+   * @brief smallest tile behaving exactly like name
+   * @paragraph
+   * Tiles of the same type and orientation have the same floor and openings,
+   * so swapping two of them changes no move and no distance. Such tiles form
+   * a class, named after its first tile.
+   */
+  inline TileNames get_tile_class(const TileNames name) const {
+    return tile_class[static_cast<std::size_t>(name)];
+  }
+
+  /// @brief next larger tile in the class of name, TileNames::End if none
+  inline TileNames get_next_in_class(const TileNames name) const {
+    return next_in_class[static_cast<std::size_t>(name)];
+  }
+
+  /// @brief whether some class has more than one tile
+  inline bool has_interchangeable_tiles() const { return interchangeable; }
+
+  /**
+   * @brief whether the pawn can step from tile src to the neighbouring tile
+   * dst lying in direction dir, as a single lookup in the precomputed table
+   */
+  inline bool can_move_pawn(const TileNames src, const TileNames dst,
+                            const Directions dir) const {
+    return (pawn_moves[static_cast<std::size_t>(src)]
+                      [static_cast<std::size_t>(dst)] >>
+            static_cast<unsigned>(dir)) &
+           1u;
+  }
+
+  /**
+   * @brief reference implementation of can_move_pawn by scanning openings
+   * @paragraph
+   * src needs an opening towards dir and dst an opening back towards src on
+   * the same floor. The move table is built from this function, and it is
+   * kept to validate and benchmark the table against.
+   */
+  bool can_move_pawn_scan(const TileNames src, const TileNames dst,
+                          const Directions dir) const {
+    const Directions required_next_opening = opposite_dir(dir);
+    for (auto& [opendir, openfloor] : get_openings(src)) {
+      if (opendir != dir) continue;
+      for (auto& [next_opendir, next_openfloor] : get_openings(dst)) {
+        if (next_opendir == required_next_opening &&
+            next_openfloor == openfloor) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
  private:
+  static constexpr std::size_t TILE_COUNT =
+      static_cast<std::size_t>(TileNames::End);
+
   std::array<GridElement, static_cast<std::size_t>(TileNames::End)> grid_info;
+  /// pawn_moves[src][dst] = bitmask of directions the pawn can step from src
+  std::array<std::array<std::uint8_t, TILE_COUNT>, TILE_COUNT> pawn_moves{};
+  std::array<std::uint8_t, TILE_COUNT> exits{};
+  std::array<TileNames, TILE_COUNT> tile_class{};
+  std::array<TileNames, TILE_COUNT> next_in_class{};
+  bool interchangeable = false;
+
+  void build_tile_classes(const input_tile_data_t& input_data) {
+    for (std::size_t t = 0; t < TILE_COUNT; t++) {
+      const auto name = static_cast<TileNames>(t);
+      tile_class[t] = name;
+      next_in_class[t] = TileNames::End;
+      for (std::size_t first = 0; first < t; first++) {
+        const auto other = static_cast<TileNames>(first);
+        if (get_tiletype(other) == get_tiletype(name) &&
+            input_data[first].second == input_data[t].second) {
+          tile_class[t] = other;
+          break;
+        }
+      }
+      // link t behind the last tile of its class seen so far
+      for (std::size_t prev = t; prev-- > 0;) {
+        if (tile_class[prev] == tile_class[t]) {
+          next_in_class[prev] = name;
+          interchangeable = true;
+          break;
+        }
+      }
+    }
+  }
+
+  void build_move_tables() {
+    static const Directions dir_array[] = {Directions::Up, Directions::Down,
+                                           Directions::Left, Directions::Right};
+    for (std::size_t src = 0; src < TILE_COUNT; src++) {
+      const auto src_name = static_cast<TileNames>(src);
+      if (src_name == TileNames::Water) continue;
+      for (auto& opening : get_openings(src_name)) {
+        exits[src] |= static_cast<std::uint8_t>(
+            1u << static_cast<unsigned>(opening.first));
+      }
+      for (std::size_t dst = 0; dst < TILE_COUNT; dst++) {
+        for (auto dir : dir_array) {
+          if (can_move_pawn_scan(src_name, static_cast<TileNames>(dst), dir)) {
+            pawn_moves[src][dst] |=
+                static_cast<std::uint8_t>(1u << static_cast<unsigned>(dir));
+          }
+        }
+      }
+    }
+  }
   TileTypes get_tiletype(TileNames name) {
     switch (name) {
       case TileNames::A:
@@ -195,55 +311,82 @@ class Board {
   }
 };
 
+class State;
+
+/// @brief at most 2 pawn moves (one per opening) and 4 tile moves per state
+constexpr std::size_t MAX_SUCCESSORS = 6;
+
+/// @brief successor list of a state, stored inline without heap allocation
+using SuccessorList = InlineVector<State, MAX_SUCCESSORS>;
+
 /**
  * @brief A class for state
  * @paragraph
  * State is used to store the board tile positions in each state and the pawn's
  * position in that place. This unique for each state in the game.
+ * @paragraph
+ * The whole state is packed into a single 64-bit word so that copies, hashing
+ * and equality are a handful of instructions:
+ * - bits [4*i, 4*i+4) hold the tile at grid position i (i in 0..9)
+ * - bits [40, 44) hold the pawn position
+ * - bits [44, 48) hold the water position
  */
 class State {
  public:
-  std::array<TileNames, static_cast<int>(TileNames::End)> tiles;
-  std::int8_t pawn_pos;
-  std::int8_t water_pos;
+  std::uint64_t bits = 0;
+
+  inline TileNames tile(const std::int8_t pos) const {
+    return static_cast<TileNames>((bits >> cell_shift(pos)) & NIBBLE);
+  }
+  inline std::int8_t pawn_pos() const {
+    return static_cast<std::int8_t>((bits >> PAWN_SHIFT) & NIBBLE);
+  }
+  inline std::int8_t water_pos() const {
+    return static_cast<std::int8_t>((bits >> WATER_SHIFT) & NIBBLE);
+  }
+
+  inline void set_tile(const std::int8_t pos, const TileNames name) {
+    set_nibble(cell_shift(pos), static_cast<std::uint64_t>(name));
+  }
+  inline void set_pawn_pos(const std::int8_t pos) {
+    set_nibble(PAWN_SHIFT, static_cast<std::uint64_t>(pos));
+  }
+  inline void set_water_pos(const std::int8_t pos) {
+    set_nibble(WATER_SHIFT, static_cast<std::uint64_t>(pos));
+  }
 
   static State from_input(std::int8_t pawn_pos, input_tile_data_t& data) {
     State st;
-    st.pawn_pos = pawn_pos;
+    st.set_pawn_pos(pawn_pos);
     for (int i = 0; i < static_cast<int>(TileNames::End); i++) {
       if (TileNames::Water == static_cast<TileNames>(i)) {
-        st.water_pos = data[i].first;
+        st.set_water_pos(data[i].first);
       }
-      st.tiles[data[i].first] = static_cast<TileNames>(i);
+      st.set_tile(data[i].first, static_cast<TileNames>(i));
     }
     return st;
   }
 
-  inline bool is_goal() const { return (this->pawn_pos == 0); }
+  inline bool is_goal() const { return (this->pawn_pos() == 0); }
 
-  std::vector<State> successors(const Board& board) const {
-    std::vector<State> successors;
+  SuccessorList successors(const Board& board) const {
+    SuccessorList successors;
+    const std::int8_t pawn = this->pawn_pos();
+    const std::int8_t water = this->water_pos();
 
-    auto cur_pawn_floor = board.get_floor(this->tiles[this->pawn_pos]);
-    // pawn movements
-    for (auto& [opendir, openfloor] :
-         board.get_openings(this->tiles[this->pawn_pos])) {
-      int8_t next_pawn_pos = to_dir(this->pawn_pos, opendir);
-      if (next_pawn_pos == -1 || next_pawn_pos == this->water_pos) {
+    const TileNames pawn_tile = this->tile(pawn);
+    auto cur_pawn_floor = board.get_floor(pawn_tile);
+    // pawn movements: one table lookup per opening of the pawn's tile
+    for (unsigned exits = board.get_exits(pawn_tile); exits != 0;
+         exits &= exits - 1) {
+      const auto opendir = static_cast<Directions>(std::countr_zero(exits));
+      int8_t next_pawn_pos = to_dir(pawn, opendir);
+      if (next_pawn_pos == -1 || next_pawn_pos == water) {
         continue;
       }
-      Directions required_next_opening = opposite_dir(opendir);
-      bool ok = false;
-      for (auto& [next_opendir, next_openfloor] :
-           board.get_openings(this->tiles[next_pawn_pos])) {
-        if (next_opendir == required_next_opening &&
-            next_openfloor == openfloor) {
-          ok = true;
-        }
-      }
-      if (ok) {
+      if (board.can_move_pawn(pawn_tile, this->tile(next_pawn_pos), opendir)) {
         State next = *this;
-        next.pawn_pos = next_pawn_pos;
+        next.set_pawn_pos(next_pawn_pos);
         successors.push_back(next);
       }
     }
@@ -255,74 +398,146 @@ class State {
     static const Directions dir_array[] = {Directions::Up, Directions::Down,
                                            Directions::Left, Directions::Right};
     for (auto& dir : dir_array) {
-      int8_t next_water_pos = to_dir(this->water_pos, dir);
-      if (next_water_pos == -1 || next_water_pos == this->pawn_pos) {
+      int8_t next_water_pos = to_dir(water, dir);
+      // the goal (position 0) is part of the board frame and never slides
+      if (next_water_pos == -1 || next_water_pos == 0 ||
+          next_water_pos == pawn) {
         continue;
       }
       State next = *this;
-      std::swap(next.tiles[water_pos], next.tiles[next_water_pos]);
-      next.water_pos = next_water_pos;
+      next.swap_cells(water, next_water_pos);
+      next.set_water_pos(next_water_pos);
       successors.push_back(next);
     }
     return successors;
   }
 
-  int heuristic(Board& b) const {
-    // manhattan distance
-    if (this->pawn_pos == 0) return 0;
-    int cost = (this->pawn_pos / 3) + (this->pawn_pos % 3) + 1;
-    bool goal_opens = false;
-    for (auto& [dir, opens] : b.get_openings(this->tiles[1])) {
-      if (dir == Directions::Left && opens == Floor::Top) {
-        goal_opens = true;
-      }
+  /**
+   * @brief representative of the states that only differ from this one by
+   * swapping interchangeable tiles
+   * @paragraph
+   * Such states have the same moves and the same distance (see
+   * Board::get_tile_class). The representative gives the tiles of each class
+   * their letters in grid order, lowest letter on the lowest position, so it
+   * is itself a valid state. It is this state when the board has no
+   * interchangeable tiles.
+   */
+  State canonical(const Board& board) const {
+    if (!board.has_interchangeable_tiles()) return *this;
+    // next letter to hand out in each class, indexed by the class
+    std::array<TileNames, 10> next_label{};
+    for (std::size_t t = 0; t < next_label.size(); t++) {
+      next_label[t] = static_cast<TileNames>(t);
+    }
+    State result = *this;
+    for (std::int8_t pos = 1; pos < 10; pos++) {
+      TileNames& label =
+          next_label[static_cast<std::size_t>(board.get_tile_class(tile(pos)))];
+      result.set_tile(pos, label);
+      label = board.get_next_in_class(label);
+    }
+    return result;
+  }
+
+  /// @brief successors mapped to their canonical form, for searching the
+  /// smaller space of canonical states
+  SuccessorList canonical_successors(const Board& board) const {
+    SuccessorList next = successors(board);
+    if (board.has_interchangeable_tiles()) {
+      for (State& s : next) s = s.canonical(board);
     }
+    return next;
+  }
+
+  /**
+   * @brief states from which this state can be reached in one move
+   * @paragraph
+   * Every move is reversible: a pawn move needs matching openings on both
+   * tiles, and sliding a tile into the water never changes the pawn's tile,
+   * so the same slide back is legal as well. The predecessor relation is
+   * therefore the successor relation itself.
+   */
+  SuccessorList predecessors(const Board& board) const {
+    return successors(board);
+  }
+
+  int heuristic(const Board& b) const {
+    // manhattan distance; cell p sits at row (p-1)/3, column (p-1)%3 and the
+    // goal one column left of cell 1
+    const std::int8_t pawn = this->pawn_pos();
+    if (pawn == 0) return 0;
+    int cost = (pawn - 1) / 3 + (pawn - 1) % 3 + 1;
+    // the tile next to the goal must open left on the top floor, otherwise it
+    // has to slide out and another tile in (a single slide if it is water).
+    // Slides never move the pawn, so this adds to the pawn's distance.
+    bool goal_opens =
+        b.can_move_pawn(this->tile(1), TileNames::Goal, Directions::Left);
     if (goal_opens == false) {
-      cost += 3;
+      cost += this->tile(1) == TileNames::Water ? 1 : 2;
     }
     return cost;
   }
 
+  /**
+   * @brief compact code of the move from this state to its successor to
+   * @paragraph
+   * `(piece << 2) | direction`: piece is 0 for the pawn and the TileNames
+   * value (1 to 8) of a sliding tile, direction is the Directions value the
+   * piece moves in. Codes are in [0, 36), so a path fits in a byte array;
+   * -1 if to is not a successor. Same move as get_action(to).
+   */
+  std::int8_t move_code(const State& to) const {
+    const std::int8_t pawn = this->pawn_pos();
+    const std::int8_t water = this->water_pos();
+    const std::int8_t to_pawn = to.pawn_pos();
+    const std::int8_t to_water = to.water_pos();
+    for (std::int8_t dir = 0; dir < 4; dir++) {
+      const auto d = static_cast<Directions>(dir);
+      if (pawn != to_pawn && State::to_dir(pawn, d) == to_pawn) return dir;
+      // the slid tile moves from the new water position into the old one
+      if (pawn == to_pawn && water != to_water &&
+          State::to_dir(to_water, d) == water) {
+        const auto piece = static_cast<int>(this->tile(to_water));
+        return static_cast<std::int8_t>((piece << 2) | dir);
+      }
+    }
+    return -1;
+  }
+
   std::string get_action(const State& to) const {
     static std::string_view tilenames_to_char[] = {
         "Goal", "A", "B", "C", "D", "E", "F", "G", "H", "Water", "End"};
 
-    if (this->pawn_pos != to.pawn_pos) {
-      if (State::to_dir(this->pawn_pos, Directions::Up) == to.pawn_pos) {
+    const std::int8_t pawn = this->pawn_pos();
+    const std::int8_t water = this->water_pos();
+    const std::int8_t to_pawn = to.pawn_pos();
+    const std::int8_t to_water = to.water_pos();
+
+    if (pawn != to_pawn) {
+      if (State::to_dir(pawn, Directions::Up) == to_pawn) {
         return "pawn: up";
-      } else if (State::to_dir(this->pawn_pos, Directions::Down) ==
-                 to.pawn_pos) {
+      } else if (State::to_dir(pawn, Directions::Down) == to_pawn) {
         return "pawn: down";
-      } else if (State::to_dir(this->pawn_pos, Directions::Left) ==
-                 to.pawn_pos) {
+      } else if (State::to_dir(pawn, Directions::Left) == to_pawn) {
         return "pawn: left";
-      } else if (State::to_dir(this->pawn_pos, Directions::Right) ==
-                 to.pawn_pos) {
+      } else if (State::to_dir(pawn, Directions::Right) == to_pawn) {
         return "pawn: right";
       } else {
         std::cerr << "error: not reachable state in path\n";
         assert(false && "error: not reachable state in path\n");
         return "";
       }
-    } else if (this->water_pos != to.water_pos) {
-      if (State::to_dir(this->water_pos, Directions::Up) == to.water_pos) {
-        return std::format("{}: down",
-                           tilenames_to_char[static_cast<std::size_t>(
-                               this->tiles[to.water_pos])]);
-      } else if (State::to_dir(this->water_pos, Directions::Down) ==
-                 to.water_pos) {
-        return std::format("{}: up", tilenames_to_char[static_cast<std::size_t>(
-                                         this->tiles[to.water_pos])]);
-      } else if (State::to_dir(this->water_pos, Directions::Left) ==
-                 to.water_pos) {
-        return std::format("{}: right",
-                           tilenames_to_char[static_cast<std::size_t>(
-                               this->tiles[to.water_pos])]);
-      } else if (State::to_dir(this->water_pos, Directions::Right) ==
-                 to.water_pos) {
-        return std::format("{}: left",
-                           tilenames_to_char[static_cast<std::size_t>(
-                               this->tiles[to.water_pos])]);
+    } else if (water != to_water) {
+      auto moved = tilenames_to_char[static_cast<std::size_t>(
+          this->tile(to_water))];
+      if (State::to_dir(water, Directions::Up) == to_water) {
+        return std::format("{}: down", moved);
+      } else if (State::to_dir(water, Directions::Down) == to_water) {
+        return std::format("{}: up", moved);
+      } else if (State::to_dir(water, Directions::Left) == to_water) {
+        return std::format("{}: right", moved);
+      } else if (State::to_dir(water, Directions::Right) == to_water) {
+        return std::format("{}: left", moved);
       } else {
         std::cerr << "error: not reachable state in path\n";
         assert(false && "error: not reachable state in path\n");
@@ -336,7 +551,7 @@ class State {
     }
   }
 
- private:
+  /// @brief grid position next to before in direction dir, -1 if none
   inline static int8_t to_dir(const int8_t before, const Directions dir) {
     static const std::array<std::array<int8_t, 4>, 10> adj = {
         //       top down left right
@@ -354,41 +569,82 @@ class State {
     if (before < 0 || before > 9) return -1;
     return adj[before][static_cast<std::size_t>(dir)];
   }
+
+ private:
+  static constexpr std::uint64_t NIBBLE = 0xF;
+  static constexpr unsigned PAWN_SHIFT = 40;
+  static constexpr unsigned WATER_SHIFT = 44;
+
+  inline static unsigned cell_shift(const std::int8_t pos) {
+    return static_cast<unsigned>(pos) * 4u;
+  }
+
+  inline void set_nibble(const unsigned shift, const std::uint64_t value) {
+    bits = (bits & ~(NIBBLE << shift)) | ((value & NIBBLE) << shift);
+  }
+
+  /// @brief swaps the tiles of two grid positions with a xor nibble swap
+  inline void swap_cells(const std::int8_t a, const std::int8_t b) {
+    const unsigned sa = cell_shift(a);
+    const unsigned sb = cell_shift(b);
+    const std::uint64_t x = ((bits >> sa) ^ (bits >> sb)) & NIBBLE;
+    bits ^= (x << sa) | (x << sb);
+  }
 };
 
 /**
  * @brief extension of std::hash and std::equal_to for template specialization
  * to type State required for the generic A* implementation
+ * @paragraph
+ * Since the state is a single packed word, the hash is one 64-bit finalizer
+ * (murmur3 fmix64) and the equality is one integer compare.
  */
 namespace std {
 template <>
 struct hash<State> {
   std::size_t operator()(const State& s) const noexcept {
-    std::size_t h = 0;
-
-    auto hash_combine = [&h](std::size_t v) {
-      h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
-    };
-
-    hash_combine(std::hash<decltype(s.pawn_pos)>{}(s.pawn_pos));
-    hash_combine(std::hash<decltype(s.water_pos)>{}(s.water_pos));
-
-    std::size_t arr_hash = 0;
-    for (auto v : s.tiles) {
-      arr_hash ^= std::hash<std::uint8_t>{}(static_cast<std::uint8_t>(v)) +
-                  0x9e3779b97f4a7c15ULL + (arr_hash << 6) + (arr_hash >> 2);
-    }
-    hash_combine(arr_hash);
-
-    return h;
+    std::uint64_t h = s.bits;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
   }
 };
 
 template <>
 struct equal_to<State> {
   bool operator()(State const& a, State const& b) const noexcept {
-    return a.pawn_pos == b.pawn_pos && a.tiles == b.tiles &&
-           a.water_pos == b.water_pos;
+    return a.bits == b.bits;
   }
 };
 }  // namespace std
+
+/**
+ * @brief the path of real states behind a path of canonical states
+ * @paragraph
+ * A search over canonical states may hop between differently labelled
+ * members of a class from one step to the next. Replaying the moves from the
+ * real start, each step picks the successor with the canonical form of the
+ * next path state, so the moves name the tiles the player actually moves.
+ * @param path canonical path starting at start.canonical(board)
+ */
+inline std::vector<State> relabel_path(const Board& board, const State& start,
+                                       const std::vector<State>& path) {
+  std::vector<State> real;
+  real.reserve(path.size());
+  if (path.empty()) return real;
+  real.push_back(start);
+  for (std::size_t i = 1; i < path.size(); i++) {
+    const State& current = real.back();
+    for (const State& next : current.successors(board)) {
+      if (std::equal_to<State>{}(next.canonical(board), path[i])) {
+        real.push_back(next);
+        break;
+      }
+    }
+    assert(real.size() == i + 1 && "path is not a path of canonical states");
+  }
+  return real;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * @file board_cache.hpp
+ * @brief Thread-safe LRU cache of per-board distance tables.
+ *
+ * Puzzles with the same tile orientations share one Board and therefore one
+ * @ref DistanceTable, after which every query on that board is a greedy
+ * descent of a few microseconds. BoardCache keeps the tables of the most
+ * recently used orientation signatures. A table is built by the first
+ * thread that misses it; threads asking for the same board meanwhile wait
+ * for that build instead of starting their own. Tables are handed out as
+ * shared pointers, so evicting one never pulls it from under a running
+ * query. A build that throws is not cached: its waiters get the exception
+ * and the next request for the board builds it again.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <distance_db.hpp>
+#include <distance_table.hpp>
+#include <exception>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <types.hpp>
+#include <unordered_map>
+
+class BoardCache {
+ public:
+  using TablePtr = std::shared_ptr<const DistanceTable>;
+
+  /**
+   * @param max_tables tables kept, each about 3.6 MB
+   * @param threads    workers of each table build
+   */
+  explicit BoardCache(std::size_t max_tables = 16, unsigned threads = 1)
+      : capacity(max_tables == 0 ? 1 : max_tables), build_threads(threads) {}
+
+  /// @brief distance table of the board of data (only orientations matter)
+  TablePtr get(const input_tile_data_t& data) {
+    const std::uint16_t signature = orientation_signature(data);
+    std::promise<TablePtr> build;
+    std::shared_future<TablePtr> table;
+    /// the miss that started this build, 0 if another thread builds
+    std::size_t build_number = 0;
+    {
+      std::lock_guard guard(lock);
+      if (auto it = entries.find(signature); it != entries.end()) {
+        hit_count++;
+        order.splice(order.begin(), order, it->second.place);
+        table = it->second.table;
+      } else {
+        build_number = ++miss_count;
+        table = build.get_future().share();
+        order.push_front(signature);
+        entries.emplace(signature, Entry{table, order.begin(), build_number});
+        while (entries.size() > capacity) {
+          entries.erase(order.back());
+          order.pop_back();
+        }
+      }
+    }
+    // built outside the lock; other threads missing this board wait on table
+    if (build_number != 0) {
+      try {
+        build.set_value(std::make_shared<const DistanceTable>(
+            Board(tile_data_from_signature(signature)), build_threads));
+      } catch (...) {
+        // forget the failed build so the next request tries again, unless it
+        // was already evicted; the threads waiting on it get the exception
+        {
+          std::lock_guard guard(lock);
+          if (auto it = entries.find(signature);
+              it != entries.end() && it->second.build == build_number) {
+            order.erase(it->second.place);
+            entries.erase(it);
+          }
+        }
+        build.set_exception(std::current_exception());
+      }
+    }
+    return table.get();
+  }
+
+  std::size_t hits() const {
+    std::lock_guard guard(lock);
+    return hit_count;
+  }
+  std::size_t misses() const {
+    std::lock_guard guard(lock);
+    return miss_count;
+  }
+  std::size_t size() const {
+    std::lock_guard guard(lock);
+    return entries.size();
+  }
+
+ private:
+  std::size_t capacity;
+  unsigned build_threads;
+  mutable std::mutex lock;
+  /// signatures, most recently used first
+  std::list<std::uint16_t> order;
+  struct Entry {
+    std::shared_future<TablePtr> table;
+    /// position of the signature in order
+    std::list<std::uint16_t>::iterator place;
+    /// the miss that built the table, tells a rebuild from the failed build
+    std::size_t build;
+  };
+  std::unordered_map<std::uint16_t, Entry> entries;
+  std::size_t hit_count = 0;
+  std::size_t miss_count = 0;
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+/**
+ * @file distance_db.hpp
+ * @brief Persistent, memory-mapped distance database, one file per board.
+ *
+ * A Board only depends on the orientations of tiles A..H, so those eight
+ * orientations (2 bits each) form a 16-bit signature that names the file.
+ * The file stores distance-to-goal modulo 3 in 2 bits per ranked state, with
+ * the value 3 meaning "unsolvable". That is 9! * 10 / 4 = 907200 bytes of
+ * payload per signature.
+ * @paragraph
+ * Neighbouring states differ in distance by at most one, so from any solvable
+ * state the neighbour whose value is one less (mod 3) is exactly one move
+ * closer to the goal. Following that chain recovers a full optimal path
+ * without ever storing the distances themselves.
+ * @paragraph
+ * File layout (native endianness):
+ * - 4 bytes magic "TTDB"
+ * - uint32 format version
+ * - uint32 orientation signature
+ * - uint32 number of ranked states
+ * - packed 2-bit values, four states per byte, lowest bits first
+ */
+
+#include <array>
+#include <board.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <distance_table.hpp>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <state_index.hpp>
+#include <string>
+#include <types.hpp>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// @brief 2 bits per tile A..H: (orientation - 1), tile A in the lowest bits
+inline std::uint16_t orientation_signature(const input_tile_data_t& data) {
+  std::uint16_t signature = 0;
+  for (std::size_t i = static_cast<std::size_t>(TileNames::A);
+       i <= static_cast<std::size_t>(TileNames::H); i++) {
+    const auto orientation = static_cast<unsigned>(data[i].second - 1) & 0x3u;
+    signature |= static_cast<std::uint16_t>(orientation << (2 * (i - 1)));
+  }
+  return signature;
+}
+
+/// @brief tile data carrying only the orientations of a signature
+inline input_tile_data_t tile_data_from_signature(std::uint16_t signature) {
+  input_tile_data_t data{};
+  for (std::size_t i = static_cast<std::size_t>(TileNames::A);
+       i <= static_cast<std::size_t>(TileNames::H); i++) {
+    data[i].first = static_cast<std::int8_t>(i);
+    data[i].second =
+        static_cast<std::int8_t>(((signature >> (2 * (i - 1))) & 0x3u) + 1);
+  }
+  data[static_cast<std::size_t>(TileNames::Water)].first = 9;
+  return data;
+}
+
+/**
+ * @brief read-only view of a whole file
+ * @paragraph
+ * Uses mmap on POSIX systems so that pages are shared between processes and
+ * only loaded when touched; elsewhere the file is read into memory.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+      release();
+      bytes = std::exchange(other.bytes, nullptr);
+      length = std::exchange(other.length, 0);
+      buffer = std::move(other.buffer);
+    }
+    return *this;
+  }
+  ~MappedFile() { release(); }
+
+  static std::optional<MappedFile> open(const std::filesystem::path& path) {
+    MappedFile file;
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return std::nullopt;
+    file.buffer.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(file.buffer.data()),
+                 static_cast<std::streamsize>(file.buffer.size()))) {
+      return std::nullopt;
+    }
+    file.bytes = file.buffer.data();
+    file.length = file.buffer.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+      ::close(fd);
+      return std::nullopt;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return std::nullopt;
+    file.bytes = static_cast<const std::uint8_t*>(mapped);
+    file.length = size;
+#endif
+    return file;
+  }
+
+  inline const std::uint8_t* data() const { return bytes; }
+  inline std::size_t size() const { return length; }
+
+ private:
+  const std::uint8_t* bytes = nullptr;
+  std::size_t length = 0;
+  std::vector<std::uint8_t> buffer;
+
+  void release() {
+#if !defined(_WIN32)
+    if (bytes != nullptr && buffer.empty()) {
+      ::munmap(const_cast<std::uint8_t*>(bytes), length);
+    }
+#endif
+    bytes = nullptr;
+    length = 0;
+    buffer.clear();
+  }
+};
+
+/**
+ * @brief memory-mapped distance-to-goal (mod 3) of every state of one board
+ */
+class DistanceDatabase {
+ public:
+  static constexpr std::uint8_t UNREACHABLE = 3;
+  static constexpr std::uint32_t VERSION = 1;
+  static constexpr std::array<char, 4> MAGIC = {'T', 'T', 'D', 'B'};
+  static constexpr std::size_t HEADER_SIZE = 16;
+  static constexpr std::size_t PAYLOAD_SIZE = (StateRanker::SIZE + 3) / 4;
+
+  /// @brief file name used for a signature inside a database directory
+  static std::string file_name(std::uint16_t signature) {
+    return std::format("{:04x}.ttdb", signature);
+  }
+
+  /// @brief maps an existing database file, std::nullopt if missing/invalid
+  static std::optional<DistanceDatabase> open(
+      const std::filesystem::path& path) {
+    auto file = MappedFile::open(path);
+    if (!file || file->size() != HEADER_SIZE + PAYLOAD_SIZE) {
+      return std::nullopt;
+    }
+    std::array<std::uint32_t, 3> header{};
+    std::memcpy(header.data(), file->data() + MAGIC.size(),
+                sizeof(std::uint32_t) * header.size());
+    if (std::memcmp(file->data(), MAGIC.data(), MAGIC.size()) != 0 ||
+        header[0] != VERSION || header[1] > 0xFFFF ||
+        header[2] != StateRanker::SIZE) {
+      return std::nullopt;
+    }
+    return DistanceDatabase(std::move(*file),
+                            static_cast<std::uint16_t>(header[1]));
+  }
+
+  /// @brief writes the mod 3 encoding of a distance table to path
+  static bool write(const std::filesystem::path& path,
+                    const DistanceTable& table, std::uint16_t signature) {
+    std::vector<std::uint8_t> payload(PAYLOAD_SIZE, 0);
+    const auto& distances = table.data();
+    for (std::size_t i = 0; i < distances.size(); i++) {
+      const std::uint8_t d = distances[i];
+      const auto value = static_cast<std::uint8_t>(
+          d == DistanceTable::UNREACHABLE ? UNREACHABLE : d % 3);
+      payload[i / 4] |= static_cast<std::uint8_t>(value << (2 * (i % 4)));
+    }
+
+    // write next to the target and rename, so readers never see partial files;
+    // the random suffix keeps concurrent builders out of each other's file
+    std::random_device entropy;
+    auto tmp_path = path;
+    tmp_path += std::format(".{:08x}{:08x}.tmp", entropy(), entropy());
+    std::error_code ec;
+    {
+      std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+      if (!out) return false;
+      const std::array<std::uint32_t, 3> header = {
+          VERSION, signature, static_cast<std::uint32_t>(StateRanker::SIZE)};
+      out.write(MAGIC.data(), MAGIC.size());
+      out.write(reinterpret_cast<const char*>(header.data()),
+                sizeof(std::uint32_t) * header.size());
+      out.write(reinterpret_cast<const char*>(payload.data()),
+                static_cast<std::streamsize>(payload.size()));
+      if (!out) {
+        out.close();
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+      }
+    }
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+      std::filesystem::remove(tmp_path, ec);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief opens the database of a board in directory, building it if needed
+   * @param directory database directory, created when missing
+   * @param data      tile data of the puzzle, only orientations are used
+   * @param threads   workers of a build, 0 means one per hardware thread
+   * @paragraph
+   * A file holding another board's signature (renamed or stale) is rebuilt.
+   */
+  static std::optional<DistanceDatabase> load_or_build(
+      const std::filesystem::path& directory, const input_tile_data_t& data,
+      unsigned threads = 0) {
+    const std::uint16_t signature = orientation_signature(data);
+    const auto path = directory / file_name(signature);
+    if (auto db = open(path); db && db->get_signature() == signature) {
+      return db;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) return std::nullopt;
+    DistanceTable table(Board(tile_data_from_signature(signature)), threads);
+    if (!write(path, table, signature)) return std::nullopt;
+    auto db = open(path);
+    if (!db || db->get_signature() != signature) return std::nullopt;
+    return db;
+  }
+
+  inline std::uint16_t get_signature() const { return signature; }
+  inline const Board& get_board() const { return board; }
+
+  /// @brief distance to goal mod 3, UNREACHABLE if unsolvable
+  inline std::uint8_t value(const State& s) const {
+    const std::size_t index = ranker.index(s);
+    const std::uint8_t packed = file.data()[HEADER_SIZE + index / 4];
+    return static_cast<std::uint8_t>((packed >> (2 * (index % 4))) & 0x3u);
+  }
+
+  inline bool is_solvable(const State& s) const {
+    return value(s) != UNREACHABLE;
+  }
+
+  /**
+   * @brief optimal path from start by descending the mod 3 chain
+   * @return the states of the path (start first), std::nullopt if unsolvable
+   */
+  std::optional<std::vector<State>> solve(const State& start) const {
+    std::uint8_t current_value = value(start);
+    if (current_value == UNREACHABLE) return std::nullopt;
+
+    std::vector<State> path;
+    path.push_back(start);
+    State current = start;
+    while (!current.is_goal()) {
+      const auto wanted = static_cast<std::uint8_t>((current_value + 2) % 3);
+      bool found = false;
+      for (const State& next : current.successors(board)) {
+        if (value(next) == wanted) {
+          current = next;
+          found = true;
+          break;
+        }
+      }
+      assert(found && "distance database is inconsistent");
+      if (!found) return std::nullopt;
+      path.push_back(current);
+      current_value = wanted;
+    }
+    return path;
+  }
+
+ private:
+  MappedFile file;
+  std::uint16_t signature;
+  Board board;
+  StateRanker ranker;
+
+  DistanceDatabase(MappedFile mapped, std::uint16_t sig)
+      : file(std::move(mapped)),
+        signature(sig),
+        board(tile_data_from_signature(sig)) {}
+};
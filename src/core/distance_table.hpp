@@ -0,0 +1,188 @@
+#pragma once
+
+/**
+ * @file distance_table.hpp
+ * @brief Exact distance-to-goal for every state of a single Board.
+ *
+ * Start positions that share tile orientations share the same Board. Instead
+ * of running A* for each of them, DistanceTable runs one backward breadth
+ * first search from every goal state over the predecessor relation and stores
+ * the optimal number of moves for every ranked state. Queries are then a
+ * table lookup, and a full optimal path is a greedy descent that only ever
+ * looks at the neighbours of the states on the path.
+ * @paragraph
+ * The search can run on several threads. Each level's frontier is cut into
+ * chunks that workers expand into their own buffers, claiming new states in
+ * an atomic visited bitset so that every state is recorded exactly once.
+ * A state's distance is its BFS level whichever thread finds it, so the
+ * table is identical to the single-threaded one.
+ * @paragraph
+ * On boards with interchangeable tiles (see State::canonical) the search
+ * only visits canonical states, up to 2!*2!*3! times fewer, and every other
+ * state then copies the distance of its canonical form.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <board.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <state_index.hpp>
+#include <thread_pool.hpp>
+#include <vector>
+
+class DistanceTable {
+ public:
+  /// @brief distance stored for states that can never reach the goal
+  static constexpr std::uint8_t UNREACHABLE = 0xFF;
+
+  /// @param threads workers of the build, 0 means one per hardware thread
+  explicit DistanceTable(const Board& b, unsigned threads = 1)
+      : board(b), distances(StateRanker::SIZE, UNREACHABLE) {
+    build(threads);
+  }
+
+  /// @brief optimal number of moves to the goal, UNREACHABLE if unsolvable
+  inline std::uint8_t distance(const State& s) const {
+    return distances[ranker.index(s)];
+  }
+
+  inline bool is_solvable(const State& s) const {
+    return distance(s) != UNREACHABLE;
+  }
+
+  /// @brief largest finite distance of the board
+  inline std::uint8_t max_distance() const { return deepest; }
+
+  /// @brief raw distances indexed by StateRanker::index
+  inline const std::vector<std::uint8_t>& data() const { return distances; }
+
+  inline const Board& get_board() const { return board; }
+
+  /**
+   * @brief optimal path from start to a goal state by greedy descent
+   * @return the states of the path (start first), std::nullopt if unsolvable
+   */
+  std::optional<std::vector<State>> solve(const State& start) const {
+    std::uint8_t d = distance(start);
+    if (d == UNREACHABLE) return std::nullopt;
+
+    std::vector<State> path;
+    path.reserve(static_cast<std::size_t>(d) + 1);
+    path.push_back(start);
+    State current = start;
+    while (d != 0) {
+      bool found = false;
+      for (const State& next : current.successors(board)) {
+        if (distance(next) == d - 1) {
+          current = next;
+          found = true;
+          break;
+        }
+      }
+      assert(found && "distance table is inconsistent");
+      if (!found) return std::nullopt;
+      path.push_back(current);
+      d--;
+    }
+    return path;
+  }
+
+ private:
+  Board board;
+  StateRanker ranker;
+  std::vector<std::uint8_t> distances;
+  std::uint8_t deepest = 0;
+
+  /// frontier states expanded per task of the parallel build
+  static constexpr std::size_t CHUNK = 4096;
+  /// frontier states whose predecessors are ranked in one batch
+  static constexpr std::size_t EXPAND_BATCH = 16;
+
+  /// @brief level synchronous BFS seeded with every goal state
+  void build(unsigned threads) {
+    std::vector<std::atomic<std::uint64_t>> visited((StateRanker::SIZE + 63) /
+                                                    64);
+    // claims index for the calling thread, false if it was already visited
+    auto claim = [&visited](std::size_t index) {
+      const std::uint64_t bit = std::uint64_t{1} << (index % 64);
+      return (visited[index / 64].fetch_or(bit, std::memory_order_relaxed) &
+              bit) == 0;
+    };
+
+    // the frontier keeps packed states, so expanding one needs no unranking
+    std::vector<State> frontier;
+    frontier.reserve(StateRanker::PERMUTATIONS);
+    // permutation of the canonical form of each permutation; relabelling
+    // never moves the pawn, so this covers every pawn position at once
+    std::vector<std::uint32_t> canonical_perm;
+    if (board.has_interchangeable_tiles()) {
+      canonical_perm.resize(StateRanker::PERMUTATIONS);
+    }
+    // goal states are exactly the ranks whose pawn position is 0
+    StateRanker::for_each_permutation([&](std::size_t perm, const State& goal) {
+      const std::size_t index = perm * StateRanker::PAWN_CELLS;
+      if (!canonical_perm.empty()) {
+        const std::size_t canonical = ranker.index(goal.canonical(board));
+        canonical_perm[perm] =
+            static_cast<std::uint32_t>(canonical / StateRanker::PAWN_CELLS);
+        if (canonical != index) return;
+      }
+      claim(index);
+      distances[index] = 0;
+      frontier.push_back(goal);
+    });
+
+    WorkStealingPool pool(threads);
+    /// next frontier found by each worker during the current level
+    std::vector<std::vector<State>> found(pool.size());
+    std::vector<State> next_frontier;
+    std::uint8_t depth = 0;
+    while (!frontier.empty()) {
+      assert(depth + 1 < UNREACHABLE && "distance does not fit in a byte");
+      const auto next_depth = static_cast<std::uint8_t>(depth + 1);
+      const std::size_t chunks = (frontier.size() + CHUNK - 1) / CHUNK;
+      pool.run(chunks, [&](unsigned worker, std::size_t chunk) {
+        const std::size_t begin = chunk * CHUNK;
+        const std::size_t end = std::min(frontier.size(), begin + CHUNK);
+        std::array<State, EXPAND_BATCH * MAX_SUCCESSORS> batch;
+        std::array<std::uint32_t, EXPAND_BATCH * MAX_SUCCESSORS> batch_index;
+        for (std::size_t i = begin; i < end; i += EXPAND_BATCH) {
+          std::size_t count = 0;
+          for (std::size_t j = i; j < std::min(end, i + EXPAND_BATCH); j++) {
+            for (const State& prev : frontier[j].predecessors(board)) {
+              batch[count++] = prev.canonical(board);
+            }
+          }
+          ranker.index_batch(batch.data(), count, batch_index.data());
+          for (std::size_t k = 0; k < count; k++) {
+            // each state is written by the one worker that claimed it
+            if (claim(batch_index[k])) {
+              distances[batch_index[k]] = next_depth;
+              found[worker].push_back(batch[k]);
+            }
+          }
+        }
+      });
+
+      next_frontier.clear();
+      for (auto& part : found) {
+        next_frontier.insert(next_frontier.end(), part.begin(), part.end());
+        part.clear();
+      }
+      if (!next_frontier.empty()) deepest = next_depth;
+      frontier.swap(next_frontier);
+      depth = next_depth;
+    }
+    // every other state takes the distance of its canonical form
+    for (std::size_t perm = 0; perm < canonical_perm.size(); perm++) {
+      if (canonical_perm[perm] == perm) continue;
+      const std::size_t from = canonical_perm[perm] * StateRanker::PAWN_CELLS;
+      std::copy_n(&distances[from], StateRanker::PAWN_CELLS,
+                  &distances[perm * StateRanker::PAWN_CELLS]);
+    }
+  }
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * @file generator.hpp
+ * @brief Puzzles of an exact optimal length for one set of tile orientations.
+ *
+ * A @ref DistanceTable already holds the optimal move count of every state of
+ * a board, so generating puzzles is only a matter of indexing its start
+ * positions by distance. PuzzleGenerator does that once with a counting sort
+ * over the table; after that a puzzle of any depth, including the hardest
+ * start of the board, is a random pick from a contiguous range.
+ */
+
+#include <batch.hpp>
+#include <board.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <distance_table.hpp>
+#include <optional>
+#include <random>
+#include <span>
+#include <state_index.hpp>
+#include <types.hpp>
+#include <unordered_set>
+#include <vector>
+
+/// @brief optimal solution lengths over all start positions of a board
+struct Census {
+  /// number of solvable starts by optimal length, indexed by moves
+  std::vector<std::size_t> histogram;
+  /// starts from which the goal cannot be reached
+  std::size_t unsolvable = 0;
+  /// optimal length of the hardest solvable start, 0 if there is none
+  int max_depth = 0;
+};
+
+class PuzzleGenerator {
+ public:
+  /**
+   * @param orientations tile data of the board, only the orientations of
+   * tiles A..H are used
+   * @param threads      workers of the distance table build, 0 means one per
+   * hardware thread
+   */
+  explicit PuzzleGenerator(const input_tile_data_t& orientations,
+                           unsigned threads = 0)
+      : tiles(orientations), table(Board(orientations), threads) {
+    index_starts();
+  }
+
+  /// @brief optimal length of the hardest start position of the board
+  inline int max_depth() const { return static_cast<int>(offsets.size()) - 2; }
+
+  /// @brief number of start positions whose optimal solution has depth moves
+  inline std::size_t count(int depth) const { return starts(depth).size(); }
+
+  /// @brief StateRanker indices of all start positions at depth
+  std::span<const std::uint32_t> starts(int depth) const {
+    if (depth < 0 || depth > max_depth()) return {};
+    const auto d = static_cast<std::size_t>(depth);
+    return std::span<const std::uint32_t>(ranks).subspan(
+        offsets[d], offsets[d + 1] - offsets[d]);
+  }
+
+  /// @brief one uniformly chosen puzzle at depth, std::nullopt if none exists
+  template <typename Rng>
+  std::optional<Puzzle> sample(int depth, Rng& rng) const {
+    const auto range = starts(depth);
+    if (range.empty()) return std::nullopt;
+    std::uniform_int_distribution<std::size_t> pick(0, range.size() - 1);
+    return puzzle(ranker.state(range[pick(rng)]));
+  }
+
+  /**
+   * @brief up to n distinct puzzles at depth, chosen uniformly
+   * @paragraph
+   * Returns every start at depth if there are no more than n of them.
+   * Uses Floyd's sampling, so the cost is O(n) whatever the size of the
+   * depth.
+   */
+  template <typename Rng>
+  std::vector<Puzzle> sample(int depth, std::size_t n, Rng& rng) const {
+    const auto range = starts(depth);
+    std::vector<Puzzle> puzzles;
+    if (n >= range.size()) {
+      puzzles.reserve(range.size());
+      for (std::uint32_t rank : range) {
+        puzzles.push_back(puzzle(ranker.state(rank)));
+      }
+      return puzzles;
+    }
+    puzzles.reserve(n);
+    std::unordered_set<std::size_t> chosen;
+    for (std::size_t j = range.size() - n; j < range.size(); j++) {
+      std::uniform_int_distribution<std::size_t> pick(0, j);
+      std::size_t i = pick(rng);
+      if (!chosen.insert(i).second) {
+        i = j;
+        chosen.insert(j);
+      }
+      puzzles.push_back(puzzle(ranker.state(range[i])));
+    }
+    return puzzles;
+  }
+
+  /// @brief distribution of the optimal lengths of all start positions
+  Census census() const {
+    Census result{{}, unsolvable, max_depth()};
+    for (int d = 0; d <= max_depth(); d++) result.histogram.push_back(count(d));
+    return result;
+  }
+
+  /// @brief the puzzle (pawn and tile positions plus orientations) of s
+  Puzzle puzzle(const State& s) const {
+    Puzzle result{s.pawn_pos(), tiles};
+    result.tiles[static_cast<std::size_t>(TileNames::Goal)] = {0, 0};
+    for (std::int8_t pos = 1; pos <= 9; pos++) {
+      result.tiles[static_cast<std::size_t>(s.tile(pos))].first = pos;
+    }
+    result.tiles[static_cast<std::size_t>(TileNames::Water)].second = 0;
+    return result;
+  }
+
+  inline const DistanceTable& get_table() const { return table; }
+
+ private:
+  input_tile_data_t tiles;
+  DistanceTable table;
+  StateRanker ranker;
+  /// start ranks sorted by distance
+  std::vector<std::uint32_t> ranks;
+  /// ranks of depth d are [offsets[d], offsets[d + 1])
+  std::vector<std::size_t> offsets;
+  /// start positions that cannot reach the goal
+  std::size_t unsolvable = 0;
+
+  /// @brief start positions of a puzzle: the pawn on one of the tiles D to H
+  static bool is_start_tile(TileNames name) {
+    return name >= TileNames::D && name <= TileNames::H;
+  }
+
+  /// @brief counting sort of the solvable start positions by distance, also
+  /// counts the unsolvable ones
+  void index_starts() {
+    const auto& distances = table.data();
+    std::vector<std::size_t> counts(
+        static_cast<std::size_t>(table.max_distance()) + 2, 0);
+    // one pass to count and one to place; permutations are stepped in rank
+    // order, so no state is decoded from its rank
+    auto for_each_start = [&](auto&& visit) {
+      StateRanker::for_each_permutation([&](std::size_t perm, const State& s) {
+        for (std::int8_t pawn = 1; pawn <= 9; pawn++) {
+          if (!is_start_tile(s.tile(pawn))) continue;
+          const std::size_t rank =
+              perm * StateRanker::PAWN_CELLS + static_cast<std::size_t>(pawn);
+          visit(rank, distances[rank]);
+        }
+      });
+    };
+    for_each_start([&](std::size_t, std::uint8_t d) {
+      if (d == DistanceTable::UNREACHABLE) {
+        unsolvable++;
+      } else {
+        counts[static_cast<std::size_t>(d) + 1]++;
+      }
+    });
+
+    // trim depths no start reaches, so max_depth() is the hardest start
+    while (counts.size() > 2 && counts.back() == 0) counts.pop_back();
+    offsets.assign(counts.size(), 0);
+    for (std::size_t d = 1; d < counts.size(); d++) {
+      offsets[d] = offsets[d - 1] + counts[d];
+    }
+    ranks.resize(offsets.back());
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    for_each_start([&](std::size_t rank, std::uint8_t d) {
+      if (d != DistanceTable::UNREACHABLE) {
+        ranks[next[d]++] = static_cast<std::uint32_t>(rank);
+      }
+    });
+  }
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+/**
+ * @file goal_seeds.hpp
+ * @brief Backward side of the bidirectional search for one start state.
+ *
+ * Any arrangement with the pawn on the goal is a goal state, so the goal set
+ * has up to 9! members. GoalSeeds hands them to the backward search lazily:
+ * only goal states whose last move can come from cell 1 (the tile there
+ * opens left on the top floor) and whose arrangement has the parity of the
+ * start are generated, level by level of the backward heuristic.
+ * @paragraph
+ * The backward heuristic is the pawn's distance to its start cell plus the
+ * distance of every tile to its start cell. A move either steps the pawn or
+ * slides one tile by one cell, so it changes this sum by at most one and
+ * the estimate is admissible and consistent.
+ * @paragraph
+ * Tiles only move by sliding into the water, so like the 8-puzzle every
+ * slide swaps two cells and moves the water by one. The parity of the
+ * arrangement relative to the start therefore always equals the parity of
+ * the water's distance to its start cell.
+ */
+
+#include <algorithm>
+#include <array>
+#include <board.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <types.hpp>
+#include <vector>
+
+class GoalSeeds {
+ public:
+  GoalSeeds(const Board& b, const State& s) : board(b), start(s) {
+    for (std::int8_t cell = 0; cell <= 9; cell++) {
+      start_cell[static_cast<std::size_t>(start.tile(cell))] = cell;
+    }
+    max_seed_level = cell_distance(0, start.pawn_pos());
+    for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+         t <= static_cast<std::size_t>(TileNames::H); t++) {
+      int farthest = 0;
+      for (std::int8_t cell = 1; cell <= 9; cell++) {
+        farthest = std::max(farthest, cell_distance(cell, start_cell[t]));
+      }
+      max_seed_level += farthest;
+    }
+  }
+
+  /// @brief lower bound of the moves between the start and s
+  inline int back_heuristic(const State& s) const {
+    int h = cell_distance(s.pawn_pos(), start.pawn_pos());
+    for (std::int8_t cell = 1; cell <= 9; cell++) {
+      const TileNames name = s.tile(cell);
+      if (name == TileNames::Water) continue;
+      h += cell_distance(cell, start_cell[static_cast<std::size_t>(name)]);
+    }
+    return h;
+  }
+
+  /// @brief upper bound of back_heuristic over all goal seeds
+  inline int max_level() const { return max_seed_level; }
+
+  /// @brief goal seeds whose back_heuristic is exactly level
+  std::vector<State> operator()(int level) const {
+    std::vector<State> seeds;
+    const int pawn_cost = cell_distance(0, start.pawn_pos());
+    if (pawn_cost > level) return seeds;
+
+    State goal;
+    goal.set_pawn_pos(0);
+    goal.set_tile(0, TileNames::Goal);
+    std::array<std::int8_t, 10> cell_of{};
+    unsigned used = 0;
+    auto place = [&](auto&& self, std::int8_t cell, int cost) -> void {
+      if (cell > 9) {
+        if (cost == level && same_parity(cell_of)) {
+          goal.set_water_pos(
+              cell_of[static_cast<std::size_t>(TileNames::Water)]);
+          seeds.push_back(goal);
+        }
+        return;
+      }
+      for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+           t <= static_cast<std::size_t>(TileNames::Water); t++) {
+        if (used & (1u << t)) continue;
+        const auto name = static_cast<TileNames>(t);
+        const int step =
+            name == TileNames::Water ? 0 : cell_distance(cell, start_cell[t]);
+        if (cost + step > level) continue;
+        if (cell == 1 &&
+            !board.can_move_pawn(name, TileNames::Goal, Directions::Left)) {
+          continue;
+        }
+        goal.set_tile(cell, name);
+        cell_of[t] = cell;
+        used |= 1u << t;
+        self(self, static_cast<std::int8_t>(cell + 1), cost + step);
+        used &= ~(1u << t);
+      }
+    };
+    place(place, 1, pawn_cost);
+    return seeds;
+  }
+
+ private:
+  Board board;
+  State start;
+  std::array<std::int8_t, static_cast<std::size_t>(TileNames::End)>
+      start_cell{};
+  int max_seed_level = 0;
+
+  /// @brief grid distance; cell p is at row (p-1)/3, column (p-1)%3 and the
+  /// goal one column left of cell 1
+  static int cell_distance(std::int8_t a, std::int8_t b) {
+    auto row = [](std::int8_t p) { return p == 0 ? 0 : (p - 1) / 3; };
+    auto col = [](std::int8_t p) { return p == 0 ? -1 : (p - 1) % 3; };
+    return std::abs(row(a) - row(b)) + std::abs(col(a) - col(b));
+  }
+
+  /// @brief whether an arrangement can be reached from the start by slides
+  bool same_parity(const std::array<std::int8_t, 10>& cell_of) const {
+    // permutation of cells 1..9 taking every tile's start cell to its cell
+    std::array<std::int8_t, 10> next{};
+    for (std::size_t t = static_cast<std::size_t>(TileNames::A);
+         t <= static_cast<std::size_t>(TileNames::Water); t++) {
+      next[static_cast<std::size_t>(start_cell[t])] = cell_of[t];
+    }
+    int transpositions = 0;
+    unsigned seen = 0;
+    for (std::int8_t cell = 1; cell <= 9; cell++) {
+      if (seen & (1u << cell)) continue;
+      for (std::int8_t c = cell; !(seen & (1u << c));
+           c = next[static_cast<std::size_t>(c)]) {
+        seen |= 1u << c;
+        transpositions++;
+      }
+      transpositions--;  // a cycle of length k is k - 1 transpositions
+    }
+    const auto water = static_cast<std::size_t>(TileNames::Water);
+    return (transpositions + cell_distance(cell_of[water], start_cell[water])) %
+               2 ==
+           0;
+  }
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+/**
+ * @file pattern_db.hpp
+ * @brief Pattern-database heuristic built per Board.
+ *
+ * The abstract state keeps the pawn, the water and a small pattern of tiles
+ * (by default the top-floor tiles A, B and C, which form the pawn's route to
+ * the goal level). Every other tile becomes a wildcard. An abstract move is
+ * allowed whenever some choice of non-pattern tiles for the wildcards allows
+ * it, so every real move maps to an abstract move. The abstract distance to
+ * the goal is therefore never larger than the real one and the heuristic is
+ * admissible. Abstract states that cannot reach the goal prove the real
+ * state unsolvable.
+ * @paragraph
+ * Distances are computed once by a backward breadth first search from every
+ * abstract goal state. Like the real game, every abstract move can be undone,
+ * so the predecessor relation is the successor relation.
+ */
+
+#include <array>
+#include <board.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <types.hpp>
+#include <vector>
+
+class PatternDatabase {
+ public:
+  /// @brief heuristic returned for states whose abstraction cannot reach goal
+  static constexpr int DEAD_END = 255;
+  static constexpr std::size_t MAX_PATTERN = 4;
+
+  explicit PatternDatabase(
+      const Board& b,
+      const std::vector<TileNames>& pattern_tiles = {
+          TileNames::A, TileNames::B, TileNames::C})
+      : board(b), pattern(pattern_tiles) {
+    assert(!pattern.empty() && pattern.size() <= MAX_PATTERN &&
+           "pattern must hold 1 to 4 tiles");
+    slot_of.fill(-1);
+    for (std::size_t i = 0; i < pattern.size(); i++) {
+      slot_of[static_cast<std::size_t>(pattern[i])] = static_cast<int>(i);
+    }
+    std::size_t size = 100;  // pawn and water digits
+    for (std::size_t i = 0; i < pattern.size(); i++) size *= 10;
+    distances.assign(size, UNREACHABLE);
+    build_wildcard_tables();
+    build();
+  }
+
+  /// @brief admissible estimate of the moves left, DEAD_END if unsolvable
+  inline int heuristic(const State& s) const {
+    const std::uint8_t d = distances[abstract_index(s)];
+    return d == UNREACHABLE ? DEAD_END : static_cast<int>(d);
+  }
+
+  /**
+   * @brief whether the state provably cannot reach the goal
+   * @paragraph
+   * Moves are reversible, so all states reachable from a start map into the
+   * same connected abstract component. Checking the start once is enough to
+   * reject an unsolvable puzzle before searching.
+   */
+  inline bool is_dead_end(const State& s) const {
+    return distances[abstract_index(s)] == UNREACHABLE;
+  }
+
+  inline std::size_t size() const { return distances.size(); }
+
+ private:
+  static constexpr std::uint8_t UNREACHABLE = 0xFF;
+  /// marks a wildcard (non-pattern tile) cell of an abstract state
+  static constexpr TileNames WILDCARD = TileNames::End;
+  static constexpr std::array<std::size_t, 6> WEIGHT = {1,    10,    100,
+                                                        1000, 10000, 100000};
+
+  Board board;
+  std::vector<TileNames> pattern;
+  std::array<int, static_cast<std::size_t>(TileNames::End)> slot_of{};
+  std::vector<std::uint8_t> distances;
+
+  /// dst_wild[src][dir]: src can step onto some non-pattern tile
+  std::array<std::array<bool, 4>, static_cast<std::size_t>(TileNames::End)>
+      dst_wild{};
+  /// src_wild[dst][dir]: some non-pattern tile can step onto dst
+  std::array<std::array<bool, 4>, static_cast<std::size_t>(TileNames::End)>
+      src_wild{};
+  /// both_wild[dir]: some non-pattern tile can step onto another
+  std::array<bool, 4> both_wild{};
+  /// some non-pattern tile is not on the top floor, so tiles may slide
+  bool wild_can_slide = false;
+
+  /// @brief abstract state decoded from an index
+  struct Abstract {
+    std::int8_t pawn;
+    std::int8_t water;
+    std::array<std::int8_t, MAX_PATTERN> pos;
+  };
+
+  bool is_wild(TileNames name) const {
+    return name != TileNames::Goal && name != TileNames::Water &&
+           slot_of[static_cast<std::size_t>(name)] < 0;
+  }
+
+  std::size_t abstract_index(const State& s) const {
+    std::size_t index = static_cast<std::size_t>(s.pawn_pos()) +
+                        WEIGHT[1] * static_cast<std::size_t>(s.water_pos());
+    for (std::int8_t cell = 1; cell <= 9; cell++) {
+      const int slot = slot_of[static_cast<std::size_t>(s.tile(cell))];
+      if (slot >= 0) {
+        index += WEIGHT[static_cast<std::size_t>(slot) + 2] *
+                 static_cast<std::size_t>(cell);
+      }
+    }
+    return index;
+  }
+
+  std::size_t encode(const Abstract& a) const {
+    std::size_t index = static_cast<std::size_t>(a.pawn) +
+                        WEIGHT[1] * static_cast<std::size_t>(a.water);
+    for (std::size_t i = 0; i < pattern.size(); i++) {
+      index += WEIGHT[i + 2] * static_cast<std::size_t>(a.pos[i]);
+    }
+    return index;
+  }
+
+  Abstract decode(std::size_t index) const {
+    Abstract a{};
+    a.pawn = static_cast<std::int8_t>(index % 10);
+    a.water = static_cast<std::int8_t>(index / 10 % 10);
+    for (std::size_t i = 0; i < pattern.size(); i++) {
+      a.pos[i] = static_cast<std::int8_t>(index / WEIGHT[i + 2] % 10);
+    }
+    return a;
+  }
+
+  /// @brief known content of a cell, or WILDCARD
+  TileNames content(const Abstract& a, std::int8_t cell) const {
+    if (cell == 0) return TileNames::Goal;
+    if (cell == a.water) return TileNames::Water;
+    for (std::size_t i = 0; i < pattern.size(); i++) {
+      if (a.pos[i] == cell) return pattern[i];
+    }
+    return WILDCARD;
+  }
+
+  bool can_move_pawn(TileNames src, TileNames dst, Directions dir) const {
+    const auto d = static_cast<std::size_t>(dir);
+    if (src == WILDCARD && dst == WILDCARD) return both_wild[d];
+    if (src == WILDCARD) return src_wild[static_cast<std::size_t>(dst)][d];
+    if (dst == WILDCARD) return dst_wild[static_cast<std::size_t>(src)][d];
+    return board.can_move_pawn(src, dst, dir);
+  }
+
+  void build_wildcard_tables() {
+    const auto tile_count = static_cast<std::size_t>(TileNames::End);
+    for (std::size_t w = static_cast<std::size_t>(TileNames::A);
+         w <= static_cast<std::size_t>(TileNames::H); w++) {
+      const auto wild = static_cast<TileNames>(w);
+      if (!is_wild(wild)) continue;
+      if (board.get_floor(wild) != Floor::Top) wild_can_slide = true;
+      for (std::size_t dir = 0; dir < 4; dir++) {
+        const auto d = static_cast<Directions>(dir);
+        for (std::size_t t = 0; t < tile_count; t++) {
+          const auto other = static_cast<TileNames>(t);
+          if (board.can_move_pawn(other, wild, d)) {
+            dst_wild[t][dir] = true;
+            if (is_wild(other)) both_wild[dir] = true;
+          }
+          if (board.can_move_pawn(wild, other, d)) src_wild[t][dir] = true;
+        }
+      }
+    }
+  }
+
+  /// @brief abstract successors; equal to the abstract predecessors
+  template <typename F>
+  void for_each_neighbour(const Abstract& a, F&& visit) const {
+    static const Directions dir_array[] = {Directions::Up, Directions::Down,
+                                           Directions::Left, Directions::Right};
+    const TileNames pawn_tile = content(a, a.pawn);
+    for (auto dir : dir_array) {
+      const std::int8_t next = State::to_dir(a.pawn, dir);
+      if (next == -1 || next == a.water) continue;
+      if (can_move_pawn(pawn_tile, content(a, next), dir)) {
+        Abstract b = a;
+        b.pawn = next;
+        visit(b);
+      }
+    }
+
+    const bool can_slide = pawn_tile == WILDCARD
+                               ? wild_can_slide
+                               : board.get_floor(pawn_tile) != Floor::Top;
+    if (!can_slide) return;
+    for (auto dir : dir_array) {
+      const std::int8_t next = State::to_dir(a.water, dir);
+      if (next == -1 || next == 0 || next == a.pawn) continue;
+      Abstract b = a;
+      for (std::size_t i = 0; i < pattern.size(); i++) {
+        if (b.pos[i] == next) b.pos[i] = a.water;
+      }
+      b.water = next;
+      visit(b);
+    }
+  }
+
+  /// @brief enumerates all abstract goal states and runs the backward BFS
+  void build() {
+    std::vector<std::uint32_t> frontier;
+    Abstract a{};
+    a.pawn = 0;
+    auto place = [&](auto&& self, std::size_t slot, unsigned used) -> void {
+      if (slot == pattern.size()) {
+        const std::size_t index = encode(a);
+        distances[index] = 0;
+        frontier.push_back(static_cast<std::uint32_t>(index));
+        return;
+      }
+      for (std::int8_t cell = 1; cell <= 9; cell++) {
+        if (used & (1u << cell)) continue;
+        a.pos[slot] = cell;
+        self(self, slot + 1, used | (1u << cell));
+      }
+    };
+    for (std::int8_t water = 1; water <= 9; water++) {
+      a.water = water;
+      place(place, 0, 1u << water);
+    }
+
+    std::vector<std::uint32_t> next_frontier;
+    std::uint8_t depth = 0;
+    while (!frontier.empty()) {
+      const auto next_depth = static_cast<std::uint8_t>(depth + 1);
+      next_frontier.clear();
+      for (std::uint32_t index : frontier) {
+        for_each_neighbour(decode(index), [&](const Abstract& prev) {
+          const std::size_t prev_index = encode(prev);
+          if (distances[prev_index] == UNREACHABLE) {
+            distances[prev_index] = next_depth;
+            next_frontier.push_back(static_cast<std::uint32_t>(prev_index));
+          }
+        });
+      }
+      frontier.swap(next_frontier);
+      depth = next_depth;
+    }
+  }
+};
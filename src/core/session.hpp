@@ -0,0 +1,158 @@
+#pragma once
+
+/**
+ * @file session.hpp
+ * @brief Next-move hints for a game in progress, reusing earlier searches.
+ *
+ * A Session follows a player through one puzzle. Every search it runs leaves
+ * two things behind, in the spirit of Adaptive A*:
+ *  - the states of the optimal path it found, with their exact distance to
+ *    the goal and their next state on that path;
+ *  - for every state it closed, the lower bound `cost - g` on its distance,
+ *    which is admissible and at least as strong as the board heuristic.
+ * While the player follows a known path a hint is a lookup. After a
+ * deviation the next search treats every state of known exact distance as a
+ * goal of that cost and is guided by the learned bounds, so it usually stops
+ * after a handful of expansions next to the old path. A detour that is not a
+ * shortcut still has to be proven so, which prepare() does ahead of time.
+ */
+
+#include <algorithm>
+#include <batch.hpp>
+#include <board.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <pattern_db.hpp>
+#include <solver.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Session {
+ public:
+  explicit Session(const Puzzle& puzzle) : board(puzzle.tiles), pdb(board) {
+    input_tile_data_t tiles = puzzle.tiles;
+    current = State::from_input(puzzle.pawn_pos, tiles);
+  }
+
+  inline const State& state() const { return current; }
+  inline const Board& get_board() const { return board; }
+
+  /// @brief optimal number of moves left, std::nullopt if unsolvable
+  std::optional<int> distance() {
+    if (!solve()) return std::nullopt;
+    return current.is_goal() ? 0 : exact.at(current).distance;
+  }
+
+  /// @brief the state after the best next move, std::nullopt at the goal or
+  /// if the goal cannot be reached
+  std::optional<State> hint() {
+    if (current.is_goal() || !solve()) return std::nullopt;
+    return exact.at(current).next;
+  }
+
+  /**
+   * @brief solves every state one move away from the current one
+   * @paragraph
+   * Proving that a detour is no shortcut can take thousands of expansions,
+   * so call this while the player thinks: afterwards the hint after any
+   * single move is a lookup.
+   */
+  void prepare() {
+    const State here = current;
+    for (const State& next : here.successors(board)) {
+      current = next;
+      solve();
+    }
+    current = here;
+  }
+
+  /// @brief plays the move to next, false (and no change) if it is not legal
+  bool advance(const State& next) {
+    for (const State& s : current.successors(board)) {
+      if (std::equal_to<State>{}(s, next)) {
+        current = next;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief plays the move with the given State::move_code, false if illegal
+  bool advance(std::int8_t move_code) {
+    for (const State& s : current.successors(board)) {
+      if (current.move_code(s) == move_code) {
+        current = s;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct Exact {
+    int distance;
+    State next;
+  };
+
+  Board board;
+  PatternDatabase pdb;
+  State current;
+  /// states on a previously found optimal path
+  std::unordered_map<State, Exact> exact;
+  /// admissible lower bounds learned from closed states of earlier searches
+  std::unordered_map<State, int> learned;
+  /// states known to have no path to the goal
+  std::unordered_set<State> dead;
+  SearchContext<State, BucketOpenList> context;
+
+  /// @brief makes sure the distance of current is known, false if unsolvable
+  bool solve() {
+    if (current.is_goal() || exact.contains(current)) return true;
+    if (dead.contains(current) || pdb.is_dead_end(current)) return false;
+
+    // Known states end the search: their remaining cost is exact. Costs are
+    // doubled and a known state's estimate is one less than twice its
+    // distance, which stays admissible but pops it before every other state
+    // of the same real f, e.g. the state the player just left ahead of the
+    // whole plateau of equally good detours.
+    auto successors = [this](const State& s) { return s.successors(board); };
+    auto goal_test = [this](const State& s) -> bool {
+      return s.is_goal() || exact.contains(s);
+    };
+    auto heuristics = [this](const State& s) -> int {
+      if (s.is_goal()) return 0;
+      if (auto it = exact.find(s); it != exact.end()) {
+        return 2 * it->second.distance - 1;
+      }
+      const int h = std::max(s.heuristic(board), pdb.heuristic(s));
+      const auto it = learned.find(s);
+      return 2 * (it == learned.end() ? h : std::max(h, it->second));
+    };
+    auto cost_between = [](const State&, const State&) -> int { return 2; };
+    const auto path = astar(context, current, successors, goal_test,
+                            heuristics, cost_between);
+    if (!path) {
+      dead.insert(current);
+      return false;
+    }
+
+    const State& end = path->back();
+    const int tail = end.is_goal() ? 0 : exact.at(end).distance;
+    const int cost = static_cast<int>(path->size()) - 1 + tail;
+    for (std::size_t i = 0; i + 1 < path->size(); i++) {
+      exact[(*path)[i]] = {cost - static_cast<int>(i), (*path)[i + 1]};
+    }
+    // every closed state s lies within g(s) of the start, so its distance is
+    // at least cost - g(s)
+    for (std::uint32_t i = 0; i < context.nodes.size(); i++) {
+      const auto& node = context.nodes[i];
+      if (!node.closed) continue;
+      int& bound = learned[node.state];
+      bound = std::max(bound, cost - node.g / 2);
+    }
+    return true;
+  }
+};
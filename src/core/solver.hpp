@@ -1,22 +1,34 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <memory_resource>
 #include <optional>
-#include <queue>
+#include <ranges>
 #include <type_traits>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 /**
  * Concepts for Successor Function type for A*
+ * any input range of states works, e.g. a `std::vector<StateType>` or a
+ * fixed-capacity inline list that never allocates
  */
 template <typename F, typename StateType>
-concept SuccessorFunc = requires(F f, const StateType& s) {
-  { f(s) } -> std::same_as<std::vector<StateType>>;
-};
+concept SuccessorFunc =
+    std::invocable<F&, const StateType&> &&
+    std::ranges::input_range<std::invoke_result_t<F&, const StateType&>> &&
+    std::convertible_to<std::ranges::range_reference_t<
+                            std::invoke_result_t<F&, const StateType&>>,
+                        StateType>;
 
 /**
  * Concepts for GoalTest Function type for A*
@@ -45,24 +57,655 @@ concept CostFunc = requires(F f, const StateType& a, const StateType& b) {
  */
 template <typename StateType>
 concept AStarState = std::copyable<StateType>;
+/**
+ * Concepts for a perfect hash of the state space: a bijection between states
+ * and the dense range [0, size()) used by the flat-array A*
+ */
+template <typename I, typename StateType>
+concept StateIndexer =
+    requires(const I& idx, const StateType& s, std::size_t i) {
+      { idx.size() } -> std::convertible_to<std::size_t>;
+      { idx.index(s) } -> std::convertible_to<std::size_t>;
+      { idx.state(i) } -> std::convertible_to<StateType>;
+    };
+
+/**
+ * Concepts for the goal seeds of a backward search
+ * `seeds(level)` returns the goal states whose backward heuristic is exactly
+ * `level`, so that a large goal set can be handed out lazily in f order
+ */
+template <typename F, typename StateType>
+concept GoalSeedFunc =
+    std::invocable<F&, int> &&
+    std::ranges::input_range<std::invoke_result_t<F&, int>> &&
+    std::convertible_to<
+        std::ranges::range_reference_t<std::invoke_result_t<F&, int>>,
+        StateType>;
+
+/**
+ * Concepts for the node type stored in an A* open list
+ * nodes expose their f and g values so that open lists can order them
+ */
+template <typename Node>
+concept OpenListNode = std::movable<Node> && requires(const Node& n) {
+  { n.f } -> std::convertible_to<int>;
+  { n.g } -> std::convertible_to<int>;
+};
+
+/**
+ * @brief binary-heap open list
+ * @paragraph
+ * Pops the node with the lowest f, ties broken by insertion order (FIFO).
+ * Works for any cost range, including large or sparse f values.
+ */
+template <OpenListNode Node>
+class HeapOpenList {
+ public:
+  explicit HeapOpenList(
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : heap(resource) {}
+
+  void push(const Node& node) {
+    heap.push_back(Entry{node, counter++});
+    std::push_heap(heap.begin(), heap.end(), Compare{});
+  }
+
+  Node pop() {
+    std::pop_heap(heap.begin(), heap.end(), Compare{});
+    Node node = std::move(heap.back().node);
+    heap.pop_back();
+    return node;
+  }
+
+  /// @brief the node pop() would return next
+  const Node& top() const { return heap.front().node; }
+
+  bool empty() const { return heap.empty(); }
+  std::size_t size() const { return heap.size(); }
+
+  /// @brief empties the list but keeps its storage for the next search
+  void clear() {
+    heap.clear();
+    counter = 0;
+  }
+
+  /// @brief empties the list and hands its storage back to the resource
+  void release() {
+    heap = std::pmr::vector<Entry>(heap.get_allocator());
+    counter = 0;
+  }
+
+ private:
+  struct Entry {
+    Node node;
+    std::size_t counter;  /// tie-breaker
+  };
+  struct Compare {
+    bool operator()(const Entry& a, const Entry& b) const {
+      if (a.node.f != b.node.f) return a.node.f > b.node.f;
+      return a.counter > b.counter;
+    }
+  };
+  std::pmr::vector<Entry> heap;  /// binary min-heap by (f, counter)
+  std::size_t counter = 0;
+};
+
+/// @brief order of nodes sharing the same f and g in a BucketOpenList
+enum class BucketOrder : std::int8_t {
+  Fifo,
+  Lifo,
+};
+
+/**
+ * @brief bucketed (Dial) open list for small non-negative integer costs
+ * @paragraph
+ * Nodes live in buckets indexed by f and, inside each f bucket, by g. Pop
+ * takes the lowest f and, among those, the highest g (the node that is
+ * deepest and so most likely closest to the goal); nodes with the same f and
+ * g come out in FIFO or LIFO order. Push and pop are O(1) amortized as long
+ * as f values stay in a small range, which holds for unit-cost puzzles with
+ * a small integer heuristic. Requires 0 <= g <= f.
+ */
+template <OpenListNode Node, BucketOrder Order = BucketOrder::Lifo>
+class BucketOpenList {
+ public:
+  explicit BucketOpenList(
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : buckets(resource) {}
+
+  void push(const Node& node) {
+    assert(node.g >= 0 && node.g <= node.f &&
+           "bucket open list requires 0 <= g <= f");
+    const auto f = static_cast<std::size_t>(node.f);
+    const auto g = static_cast<std::size_t>(node.g);
+    // nested lists are built on the resource of the outer one
+    std::pmr::memory_resource* resource = buckets.get_allocator().resource();
+    while (f >= buckets.size()) buckets.emplace_back(resource);
+    Bucket& bucket = buckets[f];
+    while (g >= bucket.cells.size()) bucket.cells.emplace_back(resource);
+    bucket.cells[g].items.push_back(node);
+    bucket.count++;
+    bucket.top_g = std::max(bucket.top_g, g);
+    min_f = std::min(min_f, f);
+    total++;
+  }
+
+  Node pop() {
+    Cell& cell = top_cell();
+    Bucket& bucket = buckets[min_f];
+
+    bucket.count--;
+    total--;
+    if constexpr (Order == BucketOrder::Lifo) {
+      Node node = std::move(cell.items.back());
+      cell.items.pop_back();
+      return node;
+    } else {
+      Node node = std::move(cell.items[cell.head++]);
+      if (cell.empty()) {
+        cell.items.clear();
+        cell.head = 0;
+      }
+      return node;
+    }
+  }
+
+  /// @brief the node pop() would return next; not const, it skips empty
+  /// buckets the same way pop() does
+  const Node& top() {
+    Cell& cell = top_cell();
+    if constexpr (Order == BucketOrder::Lifo) {
+      return cell.items.back();
+    } else {
+      return cell.items[cell.head];
+    }
+  }
+
+  bool empty() const { return total == 0; }
+  std::size_t size() const { return total; }
+
+  /// @brief empties the list but keeps the bucket storage for the next search
+  void clear() {
+    for (Bucket& bucket : buckets) {
+      for (Cell& cell : bucket.cells) {
+        cell.items.clear();
+        cell.head = 0;
+      }
+      bucket.count = 0;
+      bucket.top_g = 0;
+    }
+    min_f = std::numeric_limits<std::size_t>::max();
+    total = 0;
+  }
+
+  /// @brief empties the list and hands its storage back to the resource
+  void release() {
+    buckets = std::pmr::vector<Bucket>(buckets.get_allocator());
+    min_f = std::numeric_limits<std::size_t>::max();
+    total = 0;
+  }
+
+ private:
+  struct Cell {
+    explicit Cell(std::pmr::memory_resource* resource) : items(resource) {}
+    std::pmr::vector<Node> items;
+    std::size_t head = 0;  /// next item for FIFO order
+    bool empty() const { return head == items.size(); }
+  };
+  struct Bucket {
+    explicit Bucket(std::pmr::memory_resource* resource) : cells(resource) {}
+    std::pmr::vector<Cell> cells;  /// indexed by g
+    std::size_t count = 0;
+    std::size_t top_g = 0;  /// upper bound of the highest non-empty g
+  };
+  std::pmr::vector<Bucket> buckets;  /// indexed by f
+  std::size_t min_f = std::numeric_limits<std::size_t>::max();
+  std::size_t total = 0;
+
+  /// @brief advances min_f and top_g to the cell holding the next node
+  Cell& top_cell() {
+    assert(total > 0 && "top of empty open list");
+    while (buckets[min_f].count == 0) min_f++;
+    Bucket& bucket = buckets[min_f];
+    while (bucket.cells[bucket.top_g].empty()) bucket.top_g--;
+    return bucket.cells[bucket.top_g];
+  }
+};
+
+/// @brief BucketOpenList with FIFO order among equal (f, g)
+template <OpenListNode Node>
+using FifoBucketOpenList = BucketOpenList<Node, BucketOrder::Fifo>;
+
+/**
+ * @brief open-addressing table of search nodes
+ * @paragraph
+ * Every state seen by a search is stored once, as {state, g, parent index,
+ * closed flag}, in a dense node array. A power-of-two slot array with linear
+ * probing maps states to node indices; each slot also keeps 32 bits of the
+ * state's hash, so probing rarely touches node memory and growing never
+ * rehashes a state. Node indices are stable, so open lists and parent links
+ * refer to nodes by index instead of copying states around.
+ */
+template <typename StateType, typename Hash = std::hash<StateType>,
+          typename Eq = std::equal_to<StateType>>
+class NodeTable {
+ public:
+  static constexpr std::uint32_t NONE =
+      std::numeric_limits<std::uint32_t>::max();
+
+  struct Node {
+    StateType state;
+    int g;
+    std::uint32_t parent;
+    bool closed;
+  };
+
+  explicit NodeTable(
+      Hash h = Hash{}, Eq e = Eq{},
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : hash(h), eq(e), nodes(resource), slots(resource) {}
+
+  /**
+   * @brief index of the node holding state, inserting it if missing
+   * @return {index, inserted}; a new node has g = INT_MAX, no parent and is
+   * not closed
+   */
+  std::pair<std::uint32_t, bool> find_or_insert(const StateType& state) {
+    if ((nodes.size() + 1) * 2 > slots.size()) grow();
+    const auto h = static_cast<std::uint32_t>(hash(state));
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+      Slot& slot = slots[i];
+      if (slot.index == NONE) {
+        assert(nodes.size() < NONE && "node table full");
+        slot = Slot{static_cast<std::uint32_t>(nodes.size()), h};
+        nodes.push_back(
+            Node{state, std::numeric_limits<int>::max(), NONE, false});
+        return {slot.index, true};
+      }
+      if (slot.hash == h && eq(nodes[slot.index].state, state)) {
+        return {slot.index, false};
+      }
+    }
+  }
+
+  /// @brief index of the node holding state, NONE if it was never inserted
+  std::uint32_t find(const StateType& state) const {
+    if (slots.empty()) return NONE;
+    const auto h = static_cast<std::uint32_t>(hash(state));
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+      const Slot& slot = slots[i];
+      if (slot.index == NONE) return NONE;
+      if (slot.hash == h && eq(nodes[slot.index].state, state)) {
+        return slot.index;
+      }
+    }
+  }
+
+  inline Node& operator[](std::uint32_t index) { return nodes[index]; }
+  inline const Node& operator[](std::uint32_t index) const {
+    return nodes[index];
+  }
+
+  inline std::size_t size() const { return nodes.size(); }
+  inline std::size_t capacity() const { return slots.size(); }
+  inline double load_factor() const {
+    return slots.empty() ? 0.0
+                         : static_cast<double>(nodes.size()) /
+                               static_cast<double>(slots.size());
+  }
+
+  inline Hash hash_function() const { return hash; }
+  inline Eq key_eq() const { return eq; }
+
+  /// @brief forgets all nodes but keeps the allocated memory
+  void clear() {
+    nodes.clear();
+    std::fill(slots.begin(), slots.end(), Slot{});
+  }
+
+  /// @brief forgets all nodes and hands the storage back to the resource
+  void release() {
+    nodes = std::pmr::vector<Node>(nodes.get_allocator());
+    slots = std::pmr::vector<Slot>(slots.get_allocator());
+  }
+
+ private:
+  struct Slot {
+    std::uint32_t index = NONE;
+    std::uint32_t hash = 0;
+  };
+
+  Hash hash;
+  Eq eq;
+  std::pmr::vector<Node> nodes;
+  std::pmr::vector<Slot> slots;
+
+  void grow() {
+    std::pmr::vector<Slot> old = std::move(slots);
+    slots.assign(std::max<std::size_t>(1024, old.size() * 2), Slot{});
+    const std::size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+      if (slot.index == NONE) continue;
+      std::size_t i = slot.hash & mask;
+      while (slots[i].index != NONE) i = (i + 1) & mask;
+      slots[i] = slot;
+    }
+  }
+};
+
+/**
+ * @brief stats policy that records nothing
+ * @paragraph
+ * The default of the context based @ref astar. Every hook of the search is
+ * guarded by `if constexpr (enabled)`, so with this policy the search
+ * compiles to exactly the uninstrumented loop.
+ */
+struct NoSearchStats {
+  static constexpr bool enabled = false;
+};
+
+/**
+ * @brief counters and phase timings of one @ref astar run
+ * @paragraph
+ * Pass one to the context based @ref astar to have it filled; values of a
+ * previous search are overwritten.
+ */
+struct SearchStats {
+  static constexpr bool enabled = true;
+  using duration = std::chrono::steady_clock::duration;
+
+  std::size_t expanded = 0;       /// nodes closed and expanded
+  std::size_t generated = 0;      /// successors produced by expansions
+  std::size_t stale_skipped = 0;  /// open list pops of closed/improved nodes
+  std::size_t reopened = 0;       /// closed nodes reached by a cheaper path
+  std::size_t peak_open = 0;      /// largest open list size
+  std::size_t table_size = 0;     /// states in the node table at the end
+  double load_factor = 0.0;       /// node table fill at the end
+
+  duration init_time{};    /// clearing the context, seeding the open list
+  duration search_time{};  /// the expansion loop
+  duration path_time{};    /// following parent links back to the start
+
+  void reset() { *this = SearchStats{}; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const SearchStats& stats) {
+  using ms = std::chrono::duration<double, std::milli>;
+  return out << "expanded       " << stats.expanded << '\n'
+             << "generated      " << stats.generated << '\n'
+             << "stale skipped  " << stats.stale_skipped << '\n'
+             << "reopened       " << stats.reopened << '\n'
+             << "peak open      " << stats.peak_open << '\n'
+             << "table size     " << stats.table_size << " (load "
+             << stats.load_factor << ")\n"
+             << "init time      " << ms(stats.init_time).count() << " ms\n"
+             << "search time    " << ms(stats.search_time).count() << " ms\n"
+             << "path time      " << ms(stats.path_time).count() << " ms\n";
+}
+
+/**
+ * @brief monotonic arena behind the containers of a @ref SearchContext
+ * @paragraph
+ * Allocating bumps an offset into one buffer and deallocating does nothing,
+ * so containers growing during a search never call malloc or free. reset()
+ * takes the whole buffer back at once. What does not fit in the buffer comes
+ * from blocks of a std::pmr::monotonic_buffer_resource on the upstream
+ * resource; the next reset() returns those and grows the buffer to hold the
+ * whole search, so a context solving similar puzzles stops calling upstream
+ * after its largest search.
+ */
+class SearchArena : public std::pmr::memory_resource {
+ public:
+  explicit SearchArena(
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream_resource(upstream), overflow(upstream) {}
+  SearchArena(const SearchArena&) = delete;
+  SearchArena& operator=(const SearchArena&) = delete;
+  ~SearchArena() override { free_buffer(); }
+
+  /// @brief makes all memory available again; everything allocated from the
+  /// arena must be dropped before
+  void reset() {
+    const std::size_t needed = top + spilled;
+    overflow.release();
+    if (needed > capacity) {
+      free_buffer();
+      capacity = std::bit_ceil(needed);
+      buffer = static_cast<std::byte*>(
+          upstream_resource->allocate(capacity, alignof(std::max_align_t)));
+    }
+    top = 0;
+    spilled = 0;
+  }
+
+  inline std::pmr::memory_resource* upstream() const {
+    return upstream_resource;
+  }
+  /// @brief bytes of the buffer, not counting overflow blocks
+  inline std::size_t buffer_size() const { return capacity; }
+
+ private:
+  std::pmr::memory_resource* upstream_resource;
+  std::pmr::monotonic_buffer_resource overflow;
+  std::byte* buffer = nullptr;
+  std::size_t capacity = 0;
+  std::size_t top = 0;      /// bytes of the buffer handed out
+  std::size_t spilled = 0;  /// bytes handed out from overflow blocks
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void* p = buffer + top;
+    std::size_t space = capacity - top;
+    if (buffer != nullptr && std::align(alignment, bytes, p, space)) {
+      top = capacity - space + bytes;
+      return p;
+    }
+    spilled += bytes + alignment;
+    return overflow.allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  void free_buffer() {
+    if (buffer == nullptr) return;
+    upstream_resource->deallocate(buffer, capacity, alignof(std::max_align_t));
+    buffer = nullptr;
+  }
+};
+
+/**
+ * @brief reusable memory of the hash-map based @ref astar
+ * @paragraph
+ * Holds the node table and the open list of a search, both allocating from
+ * the context's @ref SearchArena. Every search starts by dropping them and
+ * resetting the arena, which takes all of their memory back in O(1) instead
+ * of freeing it vector by vector, so a worker that solves many puzzles with
+ * one context stops allocating once it has seen its largest search. A
+ * context must not be shared between threads. Copying a context gives a new,
+ * empty one with the same hash, equality and upstream resource.
+ */
+template <AStarState StateType,
+          template <typename> class OpenList = HeapOpenList,
+          typename Hash = std::hash<StateType>,
+          typename Eq = std::equal_to<StateType>>
+class SearchContext {
+ public:
+  /// Priority queue node
+  struct PQNode {
+    int f;
+    int g;
+    std::uint32_t index;
+  };
+
+  /// @param upstream source of the arena's memory
+  explicit SearchContext(
+      Hash h = Hash{}, Eq e = Eq{},
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : arena(upstream), nodes(h, e, &arena), open_list(&arena) {}
+  SearchContext(const SearchContext& other)
+      : SearchContext(other.nodes.hash_function(), other.nodes.key_eq(),
+                      other.arena.upstream()) {}
+  SearchContext& operator=(const SearchContext&) = delete;
+
+  /// declared first: the containers below allocate from it
+  SearchArena arena;
+  NodeTable<StateType, Hash, Eq> nodes;
+  OpenList<PQNode> open_list;
+
+  void clear() {
+    nodes.release();
+    open_list.release();
+    arena.reset();
+  }
+};
+
+/**
+ * @brief A* reusing the memory of a @ref SearchContext.
+ *
+ * Same search as the @ref astar overload without a context; the context
+ * fixes the open list policy, hash and equality.
+ *
+ * @tparam Stats         @ref NoSearchStats (default) or @ref SearchStats.
+ *
+ * @param context        Buffers of the search, cleared before use.
+ * @param start          The initial state.
+ * @param get_successors  Function that returns successors of a given state.
+ * @param is_goal         Function that checks whether a state is the goal.
+ * @param heuristic       Function that computes heuristic cost for a state.
+ * @param cost_between    Function that computes the actual cost between two
+ * states.
+ * @param stats           (Optional) Filled with counters and phase timings
+ * of this search when it is a @ref SearchStats.
+ *
+ * @return the path from start to goal if one exists, `std::nullopt`
+ * otherwise.
+ * @see SearchContext
+ */
+template <AStarState StateType, template <typename> class OpenList,
+          typename Hash, typename Eq, SuccessorFunc<StateType> Succ,
+          GoalTestFunc<StateType> Goal, HeuristicFunc<StateType> Heur,
+          CostFunc<StateType> Cost, typename Stats = NoSearchStats>
+std::optional<std::vector<StateType>> astar(
+    SearchContext<StateType, OpenList, Hash, Eq>& context,
+    const StateType& start, Succ&& get_successors, Goal&& is_goal,
+    Heur&& heuristic, Cost&& cost_between, Stats&& stats = Stats{}) {
+  constexpr bool STATS = std::remove_cvref_t<Stats>::enabled;
+  using clock = std::chrono::steady_clock;
+  [[maybe_unused]] clock::time_point phase_start;
+  if constexpr (STATS) {
+    stats.reset();
+    phase_start = clock::now();
+  }
+
+  if (is_goal(start)) return std::vector<StateType>{start};
+
+  context.clear();
+  auto& nodes = context.nodes;
+  auto& open_list = context.open_list;
+  using PQNode = typename SearchContext<StateType, OpenList, Hash, Eq>::PQNode;
+  using Table = NodeTable<StateType, Hash, Eq>;
+
+  // table and open list figures, and the end of the running phase
+  [[maybe_unused]] auto end_phase = [&](auto& phase_time) {
+    if constexpr (STATS) {
+      const auto now = clock::now();
+      phase_time = now - phase_start;
+      phase_start = now;
+      stats.table_size = nodes.size();
+      stats.load_factor = nodes.load_factor();
+    }
+  };
+
+  /// Initialize
+  const std::uint32_t start_index = nodes.find_or_insert(start).first;
+  nodes[start_index].g = 0;
+  open_list.push(PQNode{heuristic(start), 0, start_index});
+  if constexpr (STATS) {
+    stats.peak_open = 1;
+    end_phase(stats.init_time);
+  }
+
+  while (!open_list.empty()) {
+    PQNode top = open_list.pop();
+
+    // Skip if this node was expanded or improved after it was pushed
+    auto& top_node = nodes[top.index];
+    if (top_node.closed || top.g > top_node.g) {
+      if constexpr (STATS) stats.stale_skipped++;
+      continue;
+    }
+    top_node.closed = true;
+    // copy: inserting successors may reallocate the node storage
+    const StateType current = top_node.state;
+
+    if (is_goal(current)) {
+      if constexpr (STATS) end_phase(stats.search_time);
+      // path
+      std::vector<StateType> path;
+      for (std::uint32_t i = top.index; i != Table::NONE;
+           i = nodes[i].parent) {
+        path.push_back(nodes[i].state);
+      }
+      std::reverse(path.begin(), path.end());
+      if constexpr (STATS) end_phase(stats.path_time);
+      return path;
+    }
+
+    if constexpr (STATS) stats.expanded++;
+    for (const StateType& nb : get_successors(current)) {
+      int tentative_g = top.g + cost_between(current, nb);
+      if constexpr (STATS) stats.generated++;
+
+      const std::uint32_t nb_index = nodes.find_or_insert(nb).first;
+      auto& nb_node = nodes[nb_index];
+      if (tentative_g < nb_node.g) {
+        // also re-opens closed nodes reached by a cheaper path
+        if constexpr (STATS) stats.reopened += nb_node.closed;
+        nb_node.g = tentative_g;
+        nb_node.parent = top.index;
+        nb_node.closed = false;
+        int nb_f = tentative_g + heuristic(nb);
+        open_list.push(PQNode{nb_f, tentative_g, nb_index});
+        if constexpr (STATS) {
+          stats.peak_open = std::max(stats.peak_open, open_list.size());
+        }
+      }
+    }
+  }
+
+  if constexpr (STATS) end_phase(stats.search_time);
+  return std::nullopt;  /// No path
+}
 
 /**
  * @brief Generic A* (A-star) pathfinding algorithm.
  *
  * This implementation of A* works with any user-defined state type,
  * as long as it satisfies the @ref AStarState concept and provides
- * suitable hash and equality functions for use in unordered maps.
+ * suitable hash and equality functions for use in a hash table.
  *
- * The algorithm uses a priority queue (min-heap) for open set management
- * and unordered maps to maintain g-scores and f-scores.
+ * Every state is stored once in a @ref NodeTable together with its g-score,
+ * parent index and closed flag, so each successor costs a single table
+ * lookup. The open list policy (a binary min-heap by default, or
+ * @ref BucketOpenList for small integer costs) only carries (f, g, node
+ * index), and the path is rebuilt by following parent indices.
  * It returns the path from the start state to the goal as a vector of states,
  * or `std::nullopt` if no path is found.
  *
+ * @tparam OpenList  Open list policy, @ref HeapOpenList by default. Use
+ *                   @ref BucketOpenList when costs and heuristic values are
+ * small non-negative integers, e.g. `astar<BucketOpenList>(...)`.
  * @tparam StateType The type representing each search state.
  *                   Must satisfy the @ref AStarState concept.
  * @tparam Succ      Function type satisfying @ref SuccessorFunc<StateType>.
- *                   Should return a `std::vector<StateType>` of successor
- * states.
+ *                   Should return a range of successor states, either a
+ * `std::vector<StateType>` or an allocation-free fixed-capacity list.
  * @tparam Goal      Function type satisfying @ref GoalTestFunc<StateType>.
  *                   Should return `true` if the given state is a goal.
  * @tparam Heur      Function type satisfying @ref HeuristicFunc<StateType>.
@@ -82,8 +725,8 @@ concept AStarState = std::copyable<StateType>;
  * @param heuristic       Function that computes heuristic cost for a state.
  * @param cost_between    Function that computes the actual cost between two
  * states.
- * @param hash            (Optional) Hash function object for unordered_map.
- * @param eq              (Optional) Equality comparator for unordered_map.
+ * @param hash            (Optional) Hash function object for the node table.
+ * @param eq              (Optional) Equality comparator for the node table.
  *
  * @return `std::optional<std::vector<StateType>>` containing the sequence
  *         of states from start to goal if a path exists; `std::nullopt`
@@ -91,13 +734,13 @@ concept AStarState = std::copyable<StateType>;
  *
  * @note The algorithm assumes that the heuristic is *admissible* (never
  * overestimates).
- * @warning This version uses dynamic memory (`std::unordered_map`,
- * `std::priority_queue`). For deterministic or real-time systems, consider
- * replacing them with `std::pmr::unordered_map` or fixed-size arena-based
- * containers.
+ * @warning This version uses dynamic memory (the node table and the open
+ * list grow with the search). When solving many puzzles, pass a
+ * @ref SearchContext instead so that the memory is reused.
  * @see AStarState, SuccessorFunc, GoalTestFunc, HeuristicFunc, CostFunc
  */
-template <AStarState StateType, SuccessorFunc<StateType> Succ,
+template <template <typename> class OpenList = HeapOpenList,
+          AStarState StateType, SuccessorFunc<StateType> Succ,
           GoalTestFunc<StateType> Goal, HeuristicFunc<StateType> Heur,
           CostFunc<StateType> Cost, typename Hash = std::hash<StateType>,
           typename Eq = std::equal_to<StateType>>
@@ -106,74 +749,416 @@ std::optional<std::vector<StateType>> astar(const StateType& start,
                                             Goal&& is_goal, Heur&& heuristic,
                                             Cost&& cost_between,
                                             Hash hash = Hash{}, Eq eq = Eq{}) {
-  if (is_goal(start)) return std::vector<StateType>{start};
+  SearchContext<StateType, OpenList, Hash, Eq> context(hash, eq);
+  return astar(context, start, std::forward<Succ>(get_successors),
+               std::forward<Goal>(is_goal), std::forward<Heur>(heuristic),
+               std::forward<Cost>(cost_between));
+}
 
-  using ScoreMap = std::unordered_map<StateType, int, Hash, Eq>;
-  using CameFrom = std::unordered_map<StateType, StateType, Hash, Eq>;
+/**
+ * @brief A* over a bounded, perfectly hashed state space.
+ *
+ * Same search as the hash-map based @ref astar, but g-scores and parents are
+ * kept in flat arrays indexed by `indexer.index(state)`, so the hot loop does
+ * no hashing, no node allocation and never rehashes. The arrays are sized
+ * once to `indexer.size()`, which makes this overload a good fit when the
+ * whole state space is small enough to address directly.
+ *
+ * @tparam OpenList  Open list policy, see the hash-map based @ref astar.
+ * @tparam Indexer   Type satisfying @ref StateIndexer<StateType>.
+ *
+ * @param start          The initial state.
+ * @param indexer        Perfect hash between states and [0, size()).
+ * @param get_successors  Function that returns successors of a given state.
+ * @param is_goal         Function that checks whether a state is the goal.
+ * @param heuristic       Function that computes heuristic cost for a state.
+ * @param cost_between    Function that computes the actual cost between two
+ * states.
+ *
+ * @return the path from start to goal if one exists, `std::nullopt`
+ * otherwise.
+ * @see StateIndexer
+ */
+template <template <typename> class OpenList = HeapOpenList,
+          AStarState StateType, StateIndexer<StateType> Indexer,
+          SuccessorFunc<StateType> Succ, GoalTestFunc<StateType> Goal,
+          HeuristicFunc<StateType> Heur, CostFunc<StateType> Cost>
+std::optional<std::vector<StateType>> astar(const StateType& start,
+                                            const Indexer& indexer,
+                                            Succ&& get_successors,
+                                            Goal&& is_goal, Heur&& heuristic,
+                                            Cost&& cost_between) {
+  if (is_goal(start)) return std::vector<StateType>{start};
 
   const int INF = std::numeric_limits<int>::max();
+  const std::uint32_t NO_PARENT = std::numeric_limits<std::uint32_t>::max();
+  const std::size_t space = static_cast<std::size_t>(indexer.size());
+  assert(space < NO_PARENT && "state space too large for 32-bit parents");
 
-  ScoreMap g_score(0, hash, eq);
-  ScoreMap f_score(0, hash, eq);
-  CameFrom came_from(0, hash, eq);
+  std::vector<int> g_score(space, INF);
+  std::vector<std::uint32_t> came_from(space, NO_PARENT);
 
   /// Priority queue node
   struct PQNode {
     int f;
-    std::size_t counter;  /// tie-breaker
+    int g;
+    std::uint32_t index;
     StateType state;
   };
-  struct Compare {
-    bool operator()(const PQNode& a, const PQNode& b) const {
-      if (a.f != b.f) return a.f > b.f;
-      return a.counter > b.counter;
-    }
-  };
-  std::priority_queue<PQNode, std::vector<PQNode>, Compare> open_pq;
+  OpenList<PQNode> open_list;
 
   /// Initialize
-  g_score[start] = 0;
-  f_score[start] = heuristic(start);
-  std::size_t push_counter = 0;
-  open_pq.emplace(PQNode{f_score[start], push_counter++, start});
+  const auto start_index = static_cast<std::uint32_t>(indexer.index(start));
+  g_score[start_index] = 0;
+  open_list.push(PQNode{heuristic(start), 0, start_index, start});
 
-  while (!open_pq.empty()) {
-    PQNode top = open_pq.top();
-    open_pq.pop();
-    StateType current = std::move(top.state);
+  while (!open_list.empty()) {
+    PQNode top = open_list.pop();
 
-    // Skip if this node has a worse f than the latest
-    auto it_f = f_score.find(current);
-    if (it_f != f_score.end() && top.f > it_f->second) continue;
+    // Skip if a cheaper path to this node was found after it was pushed
+    if (top.g > g_score[top.index]) continue;
 
-    if (is_goal(current)) {
+    if (is_goal(top.state)) {
       // path
       std::vector<StateType> path;
-      path.push_back(current);
-      while (!eq(current, start)) {
-        current = came_from.at(current);
-        path.push_back(current);
+      path.push_back(top.state);
+      for (std::uint32_t i = came_from[top.index]; i != NO_PARENT;
+           i = came_from[i]) {
+        path.push_back(indexer.state(i));
       }
       std::reverse(path.begin(), path.end());
       return path;
     }
 
-    for (const StateType& nb : get_successors(current)) {
-      int g_current = g_score[current];
-      int tentative_g = g_current + cost_between(current, nb);
-
-      auto it_g_nb = g_score.find(nb);
-      int g_nb = (it_g_nb != g_score.end()) ? it_g_nb->second : INF;
+    for (const StateType& nb : get_successors(top.state)) {
+      int tentative_g = top.g + cost_between(top.state, nb);
+      const auto nb_index = static_cast<std::uint32_t>(indexer.index(nb));
 
-      if (tentative_g < g_nb) {
-        came_from.insert_or_assign(nb, current);
-        g_score.insert_or_assign(nb, tentative_g);
+      if (tentative_g < g_score[nb_index]) {
+        came_from[nb_index] = top.index;
+        g_score[nb_index] = tentative_g;
         int nb_f = tentative_g + heuristic(nb);
-        f_score.insert_or_assign(nb, nb_f);
-        open_pq.emplace(PQNode{nb_f, push_counter++, nb});
+        open_list.push(PQNode{nb_f, tentative_g, nb_index, nb});
       }
     }
   }
 
   return std::nullopt;  /// No path
 }
+
+/**
+ * @brief fixed-size transposition table for IDA*
+ * @paragraph
+ * Direct-mapped table remembering, per slot, one state and the lowest g it
+ * was reached with during the current iteration. Entries carry the iteration
+ * number, so starting a new iteration does not need to clear the table, and
+ * collisions simply overwrite: a lost entry only costs a re-expansion. Memory
+ * is fixed at construction no matter how large the search grows.
+ */
+template <std::default_initializable StateType,
+          typename Hash = std::hash<StateType>,
+          typename Eq = std::equal_to<StateType>>
+class TranspositionTable {
+ public:
+  /// @param entries number of slots, rounded up to a power of two
+  explicit TranspositionTable(std::size_t entries, Hash h = Hash{},
+                              Eq e = Eq{})
+      : hash(h),
+        eq(e),
+        slots(std::bit_ceil(std::max<std::size_t>(entries, 1))) {}
+
+  /**
+   * @brief records a visit of state at cost g during iteration
+   * @return false if the state was already visited in this iteration with a
+   * cost not larger than g, in which case its subtree can be skipped
+   */
+  bool visit(const StateType& state, int g, std::uint32_t iteration) {
+    Entry& entry = slots[hash(state) & (slots.size() - 1)];
+    if (entry.iteration == iteration && eq(entry.state, state)) {
+      if (entry.g <= g) return false;
+      entry.g = g;
+      return true;
+    }
+    entry = Entry{state, g, iteration};
+    return true;
+  }
+
+  inline std::size_t size() const { return slots.size(); }
+
+ private:
+  struct Entry {
+    StateType state;
+    int g;
+    std::uint32_t iteration = 0;  /// 0 never matches a real iteration
+  };
+
+  Hash hash;
+  Eq eq;
+  std::vector<Entry> slots;
+};
+
+/**
+ * @brief Iterative deepening A* (IDA*) with a bounded transposition table.
+ *
+ * Takes the same successor, goal, heuristic and cost functions as
+ * @ref astar but only keeps the current path and a fixed-size
+ * @ref TranspositionTable, so memory stays bounded however hard the puzzle
+ * is. Each iteration is a depth-first search cut off at f > bound; the next
+ * bound is the smallest f that exceeded it. Two prunings keep the search
+ * small:
+ * - parent-move pruning: the successor equal to the parent is skipped
+ * - transposition pruning: a state already reached in this iteration at the
+ *   same or lower cost is skipped (this also cuts longer cycles)
+ *
+ * With an admissible heuristic the returned path is optimal, i.e. the same
+ * length as the one from @ref astar.
+ *
+ * @param start          The initial state.
+ * @param get_successors  Function that returns successors of a given state.
+ * @param is_goal         Function that checks whether a state is the goal.
+ * @param heuristic       Function that computes heuristic cost for a state.
+ * @param cost_between    Function that computes the actual cost between two
+ * states.
+ * @param table_entries   Slots of the transposition table.
+ * @param max_cost        Give up once the bound exceeds this cost. Evicted
+ * table entries can let cycles through, so without a finite limit an
+ * unsolvable start keeps deepening forever.
+ * @param hash            (Optional) Hash function object for the table.
+ * @param eq              (Optional) Equality comparator.
+ *
+ * @return the path from start to goal if one with cost at most max_cost
+ * exists, `std::nullopt` otherwise.
+ * @see astar, TranspositionTable
+ */
+template <AStarState StateType, SuccessorFunc<StateType> Succ,
+          GoalTestFunc<StateType> Goal, HeuristicFunc<StateType> Heur,
+          CostFunc<StateType> Cost, typename Hash = std::hash<StateType>,
+          typename Eq = std::equal_to<StateType>>
+  requires std::default_initializable<StateType>
+std::optional<std::vector<StateType>> idastar(
+    const StateType& start, Succ&& get_successors, Goal&& is_goal,
+    Heur&& heuristic, Cost&& cost_between,
+    std::size_t table_entries = std::size_t{1} << 18,
+    int max_cost = std::numeric_limits<int>::max(), Hash hash = Hash{},
+    Eq eq = Eq{}) {
+  const int INF = std::numeric_limits<int>::max();
+  const int FOUND = -1;
+
+  TranspositionTable<StateType, Hash, Eq> table(table_entries, hash, eq);
+  std::vector<StateType> path{start};
+  std::uint32_t iteration = 1;
+  int bound = heuristic(start);
+
+  /// depth-first search below path.back(), returns FOUND or the next bound
+  auto search = [&](auto& self, int g) -> int {
+    const StateType current = path.back();
+    const int f = g + heuristic(current);
+    if (f > bound) return f;
+    if (is_goal(current)) return FOUND;
+    if (!table.visit(current, g, iteration)) return INF;
+
+    int next_bound = INF;
+    for (const StateType& nb : get_successors(current)) {
+      // parent-move pruning
+      if (path.size() >= 2 && eq(nb, path[path.size() - 2])) continue;
+      path.push_back(nb);
+      const int t = self(self, g + cost_between(current, nb));
+      if (t == FOUND) return FOUND;
+      next_bound = std::min(next_bound, t);
+      path.pop_back();
+    }
+    return next_bound;
+  };
+
+  while (bound <= max_cost) {
+    const int t = search(search, 0);
+    if (t == FOUND) return path;
+    if (t == INF) break;  /// whole reachable space explored
+    bound = t;
+    iteration++;
+  }
+  return std::nullopt;  /// No path
+}
+
+/**
+ * @brief Bidirectional A* from a start state to a set of goal states.
+ *
+ * A forward A* from the start and a backward A* from the goal set run in
+ * turns, always expanding the side with the smaller open list. The backward
+ * side follows predecessors and is guided by `back_heuristic`, an admissible
+ * estimate of the cost from a state back to the start. Each side keeps its
+ * own @ref NodeTable; whenever a state reached by one side is already known
+ * to the other, the two half paths form a candidate solution.
+ *
+ * The goal set may be far too large to enumerate up front, so goals enter
+ * the backward open list lazily: `goal_seeds(level)` is only asked for the
+ * goals with backward f = level once the backward search reaches that f.
+ *
+ * The search stops when the cheapest candidate costs no more than the larger
+ * of the two lowest open f values. With admissible heuristics every cheaper
+ * path would still have an open node with f below its cost on each side, so
+ * the returned path is optimal.
+ *
+ * On Temple Trap this does not beat plain A*: tens of thousands of goal
+ * states lie within a few moves of any start, so the backward bound rises
+ * too slowly to cut the forward search short, and the two sides together
+ * expand more nodes than @ref astar alone. It is therefore only reached
+ * through `solver --bidir`; every default path uses @ref astar.
+ *
+ * @tparam OpenList  Open list policy of both sides, see @ref astar.
+ * @tparam Seeds    Function type satisfying @ref GoalSeedFunc<StateType>.
+ * @tparam Pred      Function type satisfying @ref SuccessorFunc<StateType>,
+ *                   returning the states that reach a given state in one move.
+ *
+ * @param start            The initial state.
+ * @param goal_seeds       Goal states of the backward search, by level.
+ * @param max_seed_level   Largest level that may hold goal seeds.
+ * @param get_successors   Function that returns successors of a given state.
+ * @param get_predecessors Function that returns predecessors of a given state.
+ * @param is_goal          Function that checks whether a state is a goal.
+ * @param heuristic        Estimate of the cost from a state to the goal set.
+ * @param back_heuristic   Estimate of the cost from the start to a state.
+ * @param cost_between     Function that computes the actual cost between two
+ * states.
+ * @param hash             (Optional) Hash function object for the node tables.
+ * @param eq               (Optional) Equality comparator for the node tables.
+ *
+ * @return the path from start to goal if one exists, `std::nullopt`
+ * otherwise.
+ * @see astar, GoalSeedFunc
+ */
+template <template <typename> class OpenList = HeapOpenList,
+          AStarState StateType, GoalSeedFunc<StateType> Seeds,
+          SuccessorFunc<StateType> Succ, SuccessorFunc<StateType> Pred,
+          GoalTestFunc<StateType> Goal, HeuristicFunc<StateType> Heur,
+          HeuristicFunc<StateType> BackHeur, CostFunc<StateType> Cost,
+          typename Hash = std::hash<StateType>,
+          typename Eq = std::equal_to<StateType>>
+std::optional<std::vector<StateType>> bidirectional_astar(
+    const StateType& start, Seeds&& goal_seeds, int max_seed_level,
+    Succ&& get_successors, Pred&& get_predecessors, Goal&& is_goal,
+    Heur&& heuristic, BackHeur&& back_heuristic, Cost&& cost_between,
+    Hash hash = Hash{}, Eq eq = Eq{}) {
+  if (is_goal(start)) return std::vector<StateType>{start};
+
+  using Table = NodeTable<StateType, Hash, Eq>;
+  const int INF = std::numeric_limits<int>::max();
+
+  /// Priority queue node
+  struct PQNode {
+    int f;
+    int g;
+    std::uint32_t index;
+  };
+  /// one search direction
+  struct Side {
+    Table nodes;
+    OpenList<PQNode> open_list;
+  };
+  Side forward{Table(hash, eq), OpenList<PQNode>()};
+  Side backward{Table(hash, eq), OpenList<PQNode>()};
+
+  int best = INF;  /// cost of the cheapest path found so far
+  std::uint32_t meet_forward = Table::NONE;
+  std::uint32_t meet_backward = Table::NONE;  /// NONE: forward reached a goal
+  int next_seed_level = 0;
+
+  // lowest f of a side, dropping entries that were expanded or improved
+  // after they were pushed
+  auto min_f = [INF](Side& side) -> int {
+    while (!side.open_list.empty()) {
+      const PQNode& top = side.open_list.top();
+      const auto& node = side.nodes[top.index];
+      if (!node.closed && top.g <= node.g) return top.f;
+      side.open_list.pop();
+    }
+    return INF;
+  };
+
+  // records that a side reached state at cost g, and any path this closes
+  auto relax = [&](bool is_forward, const StateType& state, int g,
+                   std::uint32_t parent) {
+    Side& side = is_forward ? forward : backward;
+    Side& other = is_forward ? backward : forward;
+    const std::uint32_t index = side.nodes.find_or_insert(state).first;
+    auto& node = side.nodes[index];
+    if (g >= node.g) return;
+    // also re-opens closed nodes reached by a cheaper path
+    node.g = g;
+    node.parent = parent;
+    node.closed = false;
+    const int h = is_forward ? heuristic(state) : back_heuristic(state);
+    side.open_list.push(PQNode{g + h, g, index});
+
+    if (is_forward && g < best && is_goal(state)) {
+      best = g;
+      meet_forward = index;
+      meet_backward = Table::NONE;
+    }
+    const std::uint32_t other_index = other.nodes.find(state);
+    if (other_index != Table::NONE && g + other.nodes[other_index].g < best) {
+      best = g + other.nodes[other_index].g;
+      meet_forward = is_forward ? index : other_index;
+      meet_backward = is_forward ? other_index : index;
+    }
+  };
+
+  // lowest f of the backward side, counting goals that are not seeded yet
+  auto backward_min_f = [&]() -> int {
+    while (next_seed_level <= max_seed_level && next_seed_level < best &&
+           min_f(backward) >= next_seed_level) {
+      for (const StateType& goal : goal_seeds(next_seed_level)) {
+        relax(false, goal, 0, Table::NONE);
+      }
+      next_seed_level++;
+    }
+    const int f = min_f(backward);
+    return next_seed_level <= max_seed_level ? std::min(f, next_seed_level)
+                                             : f;
+  };
+
+  /// Initialize
+  relax(true, start, 0, Table::NONE);
+
+  while (true) {
+    const int forward_f = min_f(forward);
+    const int backward_f = backward_min_f();
+    // also stops once either side has run out of states
+    if (best <= std::max(forward_f, backward_f)) break;
+
+    const bool is_forward =
+        forward.open_list.size() <= backward.open_list.size();
+    Side& side = is_forward ? forward : backward;
+    const PQNode top = side.open_list.pop();
+    side.nodes[top.index].closed = true;
+    // copy: inserting neighbours may reallocate the node storage
+    const StateType current = side.nodes[top.index].state;
+
+    if (is_forward) {
+      for (const StateType& nb : get_successors(current)) {
+        relax(true, nb, top.g + cost_between(current, nb), top.index);
+      }
+    } else {
+      for (const StateType& nb : get_predecessors(current)) {
+        relax(false, nb, top.g + cost_between(nb, current), top.index);
+      }
+    }
+  }
+
+  if (best == INF) return std::nullopt;  /// No path
+
+  // path: start to the meeting node, then along backward parents to a goal
+  std::vector<StateType> path;
+  for (std::uint32_t i = meet_forward; i != Table::NONE;
+       i = forward.nodes[i].parent) {
+    path.push_back(forward.nodes[i].state);
+  }
+  std::reverse(path.begin(), path.end());
+  if (meet_backward != Table::NONE) {
+    for (std::uint32_t i = backward.nodes[meet_backward].parent;
+         i != Table::NONE; i = backward.nodes[i].parent) {
+      path.push_back(backward.nodes[i].state);
+    }
+  }
+  return path;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+/**
+ * @file state_index.hpp
+ * @brief Dense perfect-hash ranking of game states.
+ *
+ * The goal never leaves position 0, so a state is fully described by the
+ * permutation of the nine movable pieces (A..H and Water) over positions 1..9
+ * together with the pawn position (0..9). StateRanker maps that pair to a
+ * dense integer in [0, 9! * 10) using the Lehmer code of the permutation, and
+ * back again.
+ * @paragraph
+ * Table builders rank every state they generate, so index_batch() ranks a
+ * whole buffer of states: with AVX2, four at a time in the 64-bit lanes of a
+ * register, each lane computing the Lehmer code of its packed State.
+ * Elsewhere it is a loop over index().
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <board.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <types.hpp>
+
+// With AVX-512 VPOPCNTDQ compilers vectorize the plain loop of
+// index_batch() themselves, eight lanes wide; index4() is for AVX2 targets.
+#if defined(__AVX2__) && !defined(__AVX512VPOPCNTDQ__)
+#define STATE_INDEX_AVX2
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief bijection between State and [0, StateRanker::SIZE)
+ * @paragraph
+ * index = lehmer_rank(tiles at positions 1..9) * 10 + pawn_pos
+ * Indices whose pawn sits on the water (or whose permutation is unreachable
+ * for a given board) are valid ranks that simply never show up in a search.
+ */
+class StateRanker {
+ public:
+  static constexpr std::size_t PERMUTATIONS = 362880;  // 9!
+  static constexpr std::size_t PAWN_CELLS = 10;
+  static constexpr std::size_t SIZE = PERMUTATIONS * PAWN_CELLS;
+
+  constexpr std::size_t size() const { return SIZE; }
+
+  std::size_t index(const State& s) const {
+    return permutation_rank(s) * PAWN_CELLS +
+           static_cast<std::size_t>(s.pawn_pos());
+  }
+
+  State state(std::size_t index) const {
+    State st;
+    st.set_tile(0, TileNames::Goal);
+    st.set_pawn_pos(static_cast<std::int8_t>(index % PAWN_CELLS));
+
+    std::size_t perm = index / PAWN_CELLS;
+    unsigned unused = 0x1FF;
+    for (std::int8_t pos = 1; pos <= 9; pos++) {
+      const std::size_t weight = FACTORIAL[static_cast<std::size_t>(9 - pos)];
+      std::size_t digit = perm / weight;
+      perm %= weight;
+      // pick the digit-th smallest value that is still unused
+      unsigned remaining = unused;
+      for (; digit > 0; digit--) remaining &= remaining - 1;
+      const unsigned value = static_cast<unsigned>(std::countr_zero(remaining));
+      unused &= ~(1u << value);
+
+      const auto name = static_cast<TileNames>(value + 1);
+      st.set_tile(pos, name);
+      if (name == TileNames::Water) st.set_water_pos(pos);
+    }
+    return st;
+  }
+
+  /// @brief index() of the count states at states, written to out
+  void index_batch(const State* states, std::size_t count,
+                   std::uint32_t* out) const {
+    std::size_t i = 0;
+#ifdef STATE_INDEX_AVX2
+    for (; i + 4 <= count; i += 4) index4(states + i, out + i);
+#endif
+    for (; i < count; i++) {
+      out[i] = static_cast<std::uint32_t>(index(states[i]));
+    }
+  }
+
+  /**
+   * @brief calls visit(perm, state) for every permutation in rank order
+   * @paragraph
+   * The state has the pawn on the goal. Lehmer rank order is lexicographic
+   * order, so the permutations are stepped with std::next_permutation, far
+   * cheaper than decoding every rank with state().
+   */
+  template <typename Visitor>
+  static void for_each_permutation(Visitor&& visit) {
+    std::array<int, 9> values = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::size_t perm = 0;
+    do {
+      State st;
+      for (std::int8_t pos = 1; pos <= 9; pos++) {
+        const auto name =
+            static_cast<TileNames>(values[static_cast<std::size_t>(pos - 1)]);
+        st.set_tile(pos, name);
+        if (name == TileNames::Water) st.set_water_pos(pos);
+      }
+      visit(perm++, st);
+    } while (std::next_permutation(values.begin(), values.end()));
+  }
+
+  /// @brief lehmer code of the pieces at positions 1..9, in [0, 9!)
+  static std::size_t permutation_rank(const State& s) {
+    std::size_t rank = 0;
+    unsigned seen = 0;
+    for (std::int8_t pos = 1; pos <= 9; pos++) {
+      const unsigned value = static_cast<unsigned>(s.tile(pos)) - 1;
+      const unsigned smaller_seen =
+          static_cast<unsigned>(std::popcount(seen & ((1u << value) - 1)));
+      rank += (value - smaller_seen) *
+              FACTORIAL[static_cast<std::size_t>(9 - pos)];
+      seen |= 1u << value;
+    }
+    return rank;
+  }
+
+ private:
+  static constexpr std::array<std::size_t, 9> FACTORIAL = {
+      1, 1, 2, 6, 24, 120, 720, 5040, 40320};
+
+#ifdef STATE_INDEX_AVX2
+  static_assert(sizeof(State) == sizeof(std::uint64_t),
+                "index4 loads packed states straight from memory");
+
+  /**
+   * @brief index() of four states, one per 64-bit lane
+   * @paragraph
+   * Instead of a popcount of the smaller values seen so far, which AVX2
+   * lacks, each lane keeps nine 4-bit counters: counter k holds how many
+   * seen values are below k, and seeing value v adds one to the counters
+   * above v. The Lehmer digit of v is then v minus counter v, two shifts.
+   */
+  static void index4(const State* states, std::uint32_t* out) {
+    const __m256i bits =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states));
+    const __m256i nibble = _mm256_set1_epi64x(0xF);
+    const __m256i counter_ones = _mm256_set1_epi64x(0x111111111);
+
+    __m256i below = _mm256_setzero_si256();
+    __m256i rank = _mm256_setzero_si256();
+    for (int pos = 1; pos <= 9; pos++) {
+      // tile values run from 1, so 4 * tile is the shift of counter v + 1
+      const __m256i above_shift = _mm256_slli_epi64(
+          _mm256_and_si256(_mm256_srli_epi64(bits, 4 * pos), nibble), 2);
+      const __m256i shift =
+          _mm256_sub_epi64(above_shift, _mm256_set1_epi64x(4));
+      const __m256i digit =
+          _mm256_sub_epi64(_mm256_srli_epi64(shift, 2),
+                           _mm256_and_si256(_mm256_srlv_epi64(below, shift),
+                                            nibble));
+      const __m256i weight = _mm256_set1_epi64x(
+          static_cast<long long>(FACTORIAL[static_cast<std::size_t>(9 - pos)]));
+      rank = _mm256_add_epi64(rank, _mm256_mul_epu32(digit, weight));
+      below = _mm256_add_epi64(below,
+                               _mm256_sllv_epi64(counter_ones, above_shift));
+    }
+
+    const __m256i pawn = _mm256_and_si256(_mm256_srli_epi64(bits, 40), nibble);
+    const __m256i index = _mm256_add_epi64(
+        _mm256_mul_epu32(
+            rank, _mm256_set1_epi64x(static_cast<long long>(PAWN_CELLS))),
+        pawn);
+    // indices are below 2^32: keep the low half of each lane
+    const __m256i packed = _mm256_permutevar8x32_epi32(
+        index, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm256_castsi256_si128(packed));
+  }
+#endif
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+/**
+ * @file thread_pool.hpp
+ * @brief Work-stealing pool for loops over independent indexed tasks.
+ *
+ * Every worker owns a deque of task indices. It takes work from the back of
+ * its own deque and, once that is empty, steals from the front of the other
+ * workers' deques, so uneven tasks still keep all workers busy.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// @brief number of workers to start for a requested count, where 0 means one
+/// per hardware thread
+inline unsigned worker_count(unsigned threads) {
+  return threads != 0 ? threads
+                      : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief fixed set of worker threads sharing indexed tasks by work stealing
+ * @paragraph
+ * The helper threads are started once and wait on a condition variable
+ * between calls to run(), so a caller looping over many small rounds (e.g.
+ * one per BFS level) does not pay for starting threads each time.
+ */
+class WorkStealingPool {
+ public:
+  /// @param threads number of workers, 0 means one per hardware thread
+  explicit WorkStealingPool(unsigned threads = 0)
+      : workers(worker_count(threads)), queues(workers) {
+    helpers.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; w++) {
+      helpers.emplace_back([this, w] { serve(w); });
+    }
+  }
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  ~WorkStealingPool() {
+    {
+      std::lock_guard guard(lock);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& helper : helpers) helper.join();
+  }
+
+  inline unsigned size() const { return workers; }
+
+  /**
+   * @brief runs task(worker, index) for every index in [0, count)
+   * @paragraph
+   * Indices are dealt to the workers in contiguous blocks and rebalanced by
+   * stealing. Blocks until every task has finished. The calling thread works
+   * as worker 0. Only one thread may call run() at a time.
+   * @paragraph
+   * If a task throws, the tasks not yet started are skipped and the first
+   * exception is rethrown here once every worker has stopped.
+   */
+  template <typename Task>
+  void run(std::size_t count, Task&& task) {
+    if (count == 0) return;
+    const auto active =
+        static_cast<unsigned>(std::min<std::size_t>(workers, count));
+    for (unsigned w = 0; w < active; w++) {
+      const std::size_t begin = count * w / active;
+      const std::size_t end = count * (w + 1) / active;
+      for (std::size_t i = begin; i < end; i++) queues[w].items.push_back(i);
+    }
+
+    using TaskType = std::remove_reference_t<Task>;
+    {
+      std::lock_guard guard(lock);
+      job = {[](void* t, unsigned worker, std::size_t index) {
+               (*static_cast<TaskType*>(t))(worker, index);
+             },
+             static_cast<void*>(std::addressof(task))};
+      job_workers = active;
+      busy = active - 1;
+      failed.store(false, std::memory_order_relaxed);
+      error = nullptr;
+      generation++;
+    }
+    if (active > 1) wake.notify_all();
+
+    work(0, active);
+    std::unique_lock guard(lock);
+    done.wait(guard, [this] { return busy == 0; });
+    if (error) std::rethrow_exception(std::exchange(error, nullptr));
+  }
+
+ private:
+  /// @brief deque of task indices guarded by its own lock
+  struct Queue {
+    std::mutex lock;
+    std::deque<std::size_t> items;
+
+    std::optional<std::size_t> pop_back() {
+      std::lock_guard guard(lock);
+      if (items.empty()) return std::nullopt;
+      const std::size_t index = items.back();
+      items.pop_back();
+      return index;
+    }
+    std::optional<std::size_t> pop_front() {
+      std::lock_guard guard(lock);
+      if (items.empty()) return std::nullopt;
+      const std::size_t index = items.front();
+      items.pop_front();
+      return index;
+    }
+  };
+
+  /// @brief the task of the current run(), without its type
+  struct Job {
+    void (*invoke)(void*, unsigned, std::size_t) = nullptr;
+    void* task = nullptr;
+  };
+
+  unsigned workers;
+  std::vector<Queue> queues;
+  std::vector<std::thread> helpers;
+
+  /// guards everything below
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  Job job;
+  /// workers taking part in the current run, helpers 1 to job_workers - 1
+  unsigned job_workers = 0;
+  /// helpers of the current run still working
+  unsigned busy = 0;
+  /// counts the calls to run(), so a helper knows when a new one starts
+  std::uint64_t generation = 0;
+  bool stopping = false;
+  std::exception_ptr error;
+  /// set once a task of the current run threw, read without the lock
+  std::atomic<bool> failed = false;
+
+  /// @brief loop of helper thread self: wait for a run, work on it, repeat
+  void serve(unsigned self) {
+    std::uint64_t seen = 0;
+    while (true) {
+      unsigned active;
+      {
+        std::unique_lock guard(lock);
+        wake.wait(guard, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        active = job_workers;
+      }
+      if (self >= active) continue;
+      work(self, active);
+      std::lock_guard guard(lock);
+      if (--busy == 0) done.notify_one();
+    }
+  }
+
+  /// @brief runs tasks as worker self until no queue of the run has any left
+  void work(unsigned self, unsigned active) {
+    while (true) {
+      std::optional<std::size_t> index = queues[self].pop_back();
+      // steal from the other workers, starting with the next one
+      for (unsigned k = 1; !index && k < active; k++) {
+        index = queues[(self + k) % active].pop_front();
+      }
+      // no task is ever added, so nothing left anywhere means done
+      if (!index) return;
+      // drain the queues after an exception
+      if (failed.load(std::memory_order_relaxed)) continue;
+      try {
+        job.invoke(job.task, self, *index);
+      } catch (...) {
+        std::lock_guard guard(lock);
+        if (!error) error = std::current_exception();
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  }
+};
@@ -5,6 +5,7 @@
  */
 
 #include <array>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <utility>
@@ -25,3 +26,38 @@ enum class TileNames : std::size_t {
 
 using input_tile_data_t = std::array<std::pair<std::int8_t, std::int8_t>,
                                      static_cast<std::size_t>(TileNames::End)>;
+
+/**
+ * @brief fixed-capacity vector with inline storage
+ * @paragraph
+ * used for small bounded lists (like the successors of a state) that are
+ * produced in hot loops and must never touch the heap
+ */
+template <typename T, std::size_t N>
+class InlineVector {
+ public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  inline void push_back(const T& value) {
+    assert(count < N && "InlineVector capacity exceeded");
+    items[count++] = value;
+  }
+
+  inline std::size_t size() const { return count; }
+  inline bool empty() const { return count == 0; }
+  static constexpr std::size_t capacity() { return N; }
+
+  inline T& operator[](std::size_t i) { return items[i]; }
+  inline const T& operator[](std::size_t i) const { return items[i]; }
+
+  inline iterator begin() { return items.data(); }
+  inline iterator end() { return items.data() + count; }
+  inline const_iterator begin() const { return items.data(); }
+  inline const_iterator end() const { return items.data() + count; }
+
+ private:
+  std::array<T, N> items{};
+  std::size_t count = 0;
+};
@@ -0,0 +1,45 @@
+// Typed-array front end of tt_solve (bindings.cpp), appended to the module
+// with --post-js.
+//
+//   const input = Module.int8Buffer(17);   // views into WASM memory
+//   const moves = Module.int8Buffer(255);
+//   input.set([9, 4, 1, 7, 3, 1, 3, 2, 3, 8, 3, 3, 2, 6, 4, 9, 2]);
+//   const count = Module.solve(input, moves);  // moves[0..count) are codes
+//
+// Both arrays are passed by address, nothing is copied. A view is detached
+// when the memory grows, which only happens if a search outgrows the
+// initial memory; take a fresh view with Module.int8View(ptr, length) then.
+
+Module['UNSOLVABLE'] = -1;
+Module['INVALID_INPUT'] = -2;
+Module['BUFFER_TOO_SMALL'] = -3;
+
+/** Int8Array of length bytes allocated in WASM memory. */
+Module['int8Buffer'] = function (length) {
+  const ptr = _malloc(length);
+  return HEAP8.subarray(ptr, ptr + length);
+};
+
+/** Int8Array over length bytes of WASM memory at ptr. */
+Module['int8View'] = function (ptr, length) {
+  return HEAP8.subarray(ptr, ptr + length);
+};
+
+/** Frees a buffer returned by int8Buffer. */
+Module['freeBuffer'] = function (view) {
+  _free(view.byteOffset);
+};
+
+/**
+ * Solves the 17-byte puzzle in input and writes one move code per move to
+ * output: (piece << 2) | direction, piece 0 for the pawn or 1 to 8 for tiles
+ * A to H, direction 0 up, 1 down, 2 left, 3 right.
+ * Returns the number of moves or one of the negative codes above.
+ */
+Module['solve'] = function (input, output) {
+  if (input.buffer !== HEAP8.buffer || output.buffer !== HEAP8.buffer) {
+    throw new TypeError('solve() needs views of the module memory, see int8Buffer()');
+  }
+  if (input.length < 17) return Module['INVALID_INPUT'];
+  return _tt_solve(input.byteOffset, output.byteOffset, output.length);
+};
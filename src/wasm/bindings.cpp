@@ -0,0 +1,62 @@
+/**
+ * @file bindings.cpp
+ * @brief WebAssembly entry point of the solver.
+ *
+ * The solver is exported as a plain C function working on raw byte buffers,
+ * so a solve crosses the JS/WASM boundary as three integers and no object is
+ * built on either side. `api.js`, appended to the generated module, wraps it
+ * as `Module.solve(input, output)` for Int8Arrays living in WASM memory.
+ *
+ * Input (17 bytes): the pawn position, then position and orientation of each
+ * of the tiles A to H, the same numbers as one line of `solver --batch`.
+ * Output: one move code per move, see State::move_code.
+ */
+
+#include <array>
+#include <batch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <emscripten/emscripten.h>
+
+namespace {
+
+/// return values of tt_solve that are not a move count
+constexpr int TT_UNSOLVABLE = -1;
+constexpr int TT_INVALID_INPUT = -2;
+constexpr int TT_BUFFER_TOO_SMALL = -3;
+
+/// one solver for the module lifetime, so its search memory is reused
+PuzzleSolver& solver() {
+  static PuzzleSolver instance;
+  return instance;
+}
+
+}  // namespace
+
+extern "C" {
+
+/**
+ * @brief solves the puzzle in input and writes its move codes to moves
+ * @param input    17 bytes, see the file comment
+ * @param moves    output buffer of capacity bytes; 255 bytes always suffice
+ * @return the number of moves written, TT_UNSOLVABLE, TT_INVALID_INPUT, or
+ * TT_BUFFER_TOO_SMALL (nothing is written then)
+ */
+EMSCRIPTEN_KEEPALIVE int tt_solve(const std::int8_t* input,
+                                  std::int8_t* moves, int capacity) {
+  std::array<int, 16> tiles{};
+  for (std::size_t i = 0; i < tiles.size(); i++) tiles[i] = input[i + 1];
+  const auto puzzle = make_puzzle(input[0], tiles);
+  if (!puzzle) return TT_INVALID_INPUT;
+
+  const Solution path = solver().solve(*puzzle);
+  if (!path) return TT_UNSOLVABLE;
+  const int count = static_cast<int>(path->size()) - 1;
+  if (count > capacity) return TT_BUFFER_TOO_SMALL;
+  for (std::size_t i = 1; i < path->size(); i++) {
+    moves[i - 1] = (*path)[i - 1].move_code((*path)[i]);
+  }
+  return count;
+}
+
+}  // extern "C"
@@ -0,0 +1,57 @@
+// Solves puzzle lines with the WebAssembly build under Node and prints them
+// in the format of `solver --batch`, so the two can be diffed:
+//
+//   node src/wasm/solve.mjs build/emscripten-release/bin/wasm/temple_trap_solver.js \
+//       '9 41 73 13 23 83 32 64 92'
+//
+// Without puzzle arguments the lines are read from stdin.
+
+import { createRequire } from 'node:module';
+import path from 'node:path';
+import readline from 'node:readline';
+
+const PIECES = ['pawn', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H'];
+const DIRECTIONS = ['up', 'down', 'left', 'right'];
+
+const [modulePath, ...args] = process.argv.slice(2);
+if (!modulePath) {
+  console.error('usage: node solve.mjs <temple_trap_solver.js> [puzzle...]');
+  process.exit(2);
+}
+const require = createRequire(import.meta.url);
+const Module = await require(path.resolve(modulePath))();
+
+let input = Module.int8Buffer(17);
+let moves = Module.int8Buffer(255);
+const inputPtr = input.byteOffset;
+const movesPtr = moves.byteOffset;
+
+function solveLine(line) {
+  // views are detached (length 0) if the last search grew the memory
+  if (input.length === 0) input = Module.int8View(inputPtr, 17);
+  if (moves.length === 0) moves = Module.int8View(movesPtr, 255);
+  const tokens = line.trim().split(/\s+/);
+  if (tokens.length !== 9 || tokens.slice(1).some((t) => t.length !== 2)) {
+    return 'invalid';
+  }
+  input[0] = Number(tokens[0]);
+  tokens.slice(1).forEach((t, i) => {
+    input[1 + 2 * i] = Number(t[0]);
+    input[2 + 2 * i] = Number(t[1]);
+  });
+  const count = Module.solve(input, moves);
+  if (moves.length === 0) moves = Module.int8View(movesPtr, 255);
+  if (count === Module.INVALID_INPUT) return 'invalid';
+  if (count === Module.UNSOLVABLE) return '-1';
+  const words = [String(count)];
+  for (const code of moves.subarray(0, count)) {
+    words.push(`${PIECES[code >> 2]}:${DIRECTIONS[code & 3]}`);
+  }
+  return words.join(' ');
+}
+
+const lines = args.length > 0 ? args : readline.createInterface({ input: process.stdin });
+for await (const line of lines) {
+  if (line.trim() === '' || line.trim().startsWith('#')) continue;
+  console.log(solveLine(line));
+}